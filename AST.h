@@ -1,6 +1,7 @@
 #ifndef AST_H
 #define AST_H
 
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,10 +27,62 @@ enum class ASTNodeType {
     END
 };
 
+// Что обозначает узел Factor.
+enum class FactorKind {
+    None,
+    Number,     // числовой литерал, значение в ASTNode::number
+    String,     // строковый литерал
+    Name,       // имя переменной или константы
+    Call        // вызов функции, аргументы — дети узла
+};
+
+// Статический тип значения (см. TypeChecker.h). Числовые типы упорядочены по
+// расширению: boolean -> integer -> real. Во время выполнения все они — double.
+enum class ValueType : uint8_t {
+    Unknown,
+    Boolean,
+    Integer,
+    Real,
+    String
+};
+
+inline const char *astNodeTypeName(ASTNodeType type) {
+    switch (type) {
+        case ASTNodeType::Program: return "Program";
+        case ASTNodeType::Block: return "Block";
+        case ASTNodeType::ConstDecl: return "ConstDecl";
+        case ASTNodeType::VarDecl: return "VarDecl";
+        case ASTNodeType::TemplateDecl: return "TemplateDecl";
+        case ASTNodeType::ClassDecl: return "ClassDecl";
+        case ASTNodeType::StatementBlock: return "StatementBlock";
+        case ASTNodeType::Assignment: return "Assignment";
+        case ASTNodeType::IfStatement: return "IfStatement";
+        case ASTNodeType::WhileStatement: return "WhileStatement";
+        case ASTNodeType::ProcedureCall: return "ProcedureCall";
+        case ASTNodeType::Expression: return "Expression";
+        case ASTNodeType::Term: return "Term";
+        case ASTNodeType::Factor: return "Factor";
+        case ASTNodeType::Unknown: return "Unknown";
+        case ASTNodeType::END: return "END";
+    }
+    return "Unknown";
+}
+
 struct ASTNode {
     ASTNodeType type;
     std::string value;
     std::vector<std::shared_ptr<ASTNode>> children;
+    FactorKind factor = FactorKind::None;
+    double number = 0.0;
+    // Заполняется при разрешении имён: ячейка кадра для имён и присваиваний,
+    // номер встроенной функции для вызовов.
+    int slot = -1;
+    // Тоже при разрешении: номер интернированного имени и глубина области
+    // видимости, где имя объявлено (привязка «глубина, ячейка»).
+    int symbol = -1;
+    int scopeDepth = -1;
+    // Тип выражения или объявленной переменной после проверки типов.
+    ValueType valueType = ValueType::Unknown;
 
     ASTNode(ASTNodeType type, std::string value = "")
             : type(type), value(std::move(value)) {}
@@ -38,9 +91,61 @@ struct ASTNode {
         children.push_back(child);
     }
 
+    bool isNumber() const {
+        return type == ASTNodeType::Factor && factor == FactorKind::Number;
+    }
+};
 
+// Операторы узлов Expression и Term.
+enum class BinaryOp {
+    Add, Sub, Mul, Div,
+    Lt, Gt, Le, Ge, Eq, Ne,
+    Invalid
+};
 
+inline BinaryOp binaryOp(const std::string &op) {
+    if (op.size() == 1) {
+        switch (op[0]) {
+            case '+': return BinaryOp::Add;
+            case '-': return BinaryOp::Sub;
+            case '*': return BinaryOp::Mul;
+            case '/': return BinaryOp::Div;
+            case '<': return BinaryOp::Lt;
+            case '>': return BinaryOp::Gt;
+            case '=': return BinaryOp::Eq;
+        }
+    } else if (op == "<=") {
+        return BinaryOp::Le;
+    } else if (op == ">=") {
+        return BinaryOp::Ge;
+    } else if (op == "<>") {
+        return BinaryOp::Ne;
+    }
+    return BinaryOp::Invalid;
+}
 
-};
+// Имена, объявленные узлом ConstDecl ("eps = 0.000100") или VarDecl ("a, b : real").
+inline std::vector<std::string> declaredNames(const ASTNode &node) {
+    std::vector<std::string> names;
+    std::string list = node.value;
+    if (node.type == ASTNodeType::ConstDecl) {
+        size_t eq = list.find(" = ");
+        if (eq == std::string::npos) return names;
+        list.resize(eq);
+    } else if (node.type == ASTNodeType::VarDecl) {
+        size_t colon = list.find(" : ");
+        if (colon != std::string::npos) list.resize(colon);
+    } else {
+        return names;
+    }
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(", ", start);
+        if (comma == std::string::npos) comma = list.size();
+        if (comma > start) names.push_back(list.substr(start, comma - start));
+        start = comma + 2;
+    }
+    return names;
+}
 
 #endif
@@ -0,0 +1,215 @@
+#include "AllocProfile.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+
+constexpr size_t PHASES = static_cast<size_t>(StatsPhase::Count) + 1;
+constexpr size_t NODE_TYPES = static_cast<size_t>(ASTNodeType::END) + 1;
+
+struct Counters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> freedBytes{0};
+    std::atomic<uint64_t> peakLive{0};
+};
+
+std::atomic<bool> profiling{false};
+std::atomic<int64_t> live{0};
+Counters total;
+Counters phases[PHASES];
+Counters nodes[NODE_TYPES];
+
+void raise(std::atomic<uint64_t> &peak, uint64_t value) {
+    uint64_t seen = peak.load(std::memory_order_relaxed);
+    while (seen < value && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+void recordAllocation(size_t bytes) {
+    // Освобождение блоков, выделенных до включения профиля, уводит live ниже
+    // нуля: пик считается только по положительным значениям.
+    int64_t now = live.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) +
+                  static_cast<int64_t>(bytes);
+    Counters &phase = phases[static_cast<size_t>(activePhase)];
+    for (Counters *c: {&total, &phase}) {
+        c->allocations.fetch_add(1, std::memory_order_relaxed);
+        c->bytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (now > 0) raise(c->peakLive, static_cast<uint64_t>(now));
+    }
+    if (allocNodeType >= 0) {
+        Counters &node = nodes[static_cast<size_t>(allocNodeType)];
+        node.allocations.fetch_add(1, std::memory_order_relaxed);
+        node.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+void recordFree(size_t bytes) {
+    live.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    Counters &phase = phases[static_cast<size_t>(activePhase)];
+    for (Counters *c: {&total, &phase}) {
+        c->frees.fetch_add(1, std::memory_order_relaxed);
+        c->freedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+AllocCounters snapshot(const Counters &c) {
+    AllocCounters result;
+    result.allocations = c.allocations.load(std::memory_order_relaxed);
+    result.bytes = c.bytes.load(std::memory_order_relaxed);
+    result.frees = c.frees.load(std::memory_order_relaxed);
+    result.freedBytes = c.freedBytes.load(std::memory_order_relaxed);
+    result.peakLive = c.peakLive.load(std::memory_order_relaxed);
+    return result;
+}
+
+// Размер блока glibc знает сама (фактический, с округлением malloc); на
+// остальных платформах запрошенный размер хранится в заголовке перед
+// указателем, который получает вызывающий.
+#ifdef __GLIBC__
+void *allocate(size_t size) {
+    return std::malloc(size);
+}
+
+size_t blockSize(void *p) {
+    return malloc_usable_size(p);
+}
+
+void release(void *p) {
+    std::free(p);
+}
+#else
+constexpr size_t HEADER = alignof(std::max_align_t);
+
+void *allocate(size_t size) {
+    if (size > SIZE_MAX - HEADER) return nullptr;
+    auto *block = static_cast<char *>(std::malloc(size + HEADER));
+    if (!block) return nullptr;
+    *reinterpret_cast<size_t *>(block) = size;
+    return block + HEADER;
+}
+
+size_t blockSize(void *p) {
+    return *reinterpret_cast<size_t *>(static_cast<char *>(p) - HEADER);
+}
+
+void release(void *p) {
+    std::free(static_cast<char *>(p) - HEADER);
+}
+#endif
+
+const char *phaseTitle(size_t phase) {
+    return phase < static_cast<size_t>(StatsPhase::Count) ? statsPhaseName(static_cast<StatsPhase>(phase)) : "other";
+}
+
+}
+
+void *operator new(std::size_t size) {
+    void *p = allocate(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    if (profiling.load(std::memory_order_relaxed)) recordAllocation(blockSize(p));
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    if (!p) return;
+    if (profiling.load(std::memory_order_relaxed)) recordFree(blockSize(p));
+    release(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+void enableAllocProfile(bool enabled) {
+    if (enabled && !profiling.load()) live = 0;
+    profiling = enabled;
+}
+
+bool allocProfileEnabled() {
+    return profiling.load(std::memory_order_relaxed);
+}
+
+AllocCounters allocTotals() {
+    return snapshot(total);
+}
+
+int64_t allocLiveBytes() {
+    return live.load(std::memory_order_relaxed);
+}
+
+AllocCounters allocPhase(StatsPhase phase) {
+    return snapshot(phases[static_cast<size_t>(phase)]);
+}
+
+AllocCounters allocNodeKind(ASTNodeType type) {
+    return snapshot(nodes[static_cast<size_t>(type)]);
+}
+
+void printAllocProfile(std::ostream &out, bool json) {
+    AllocCounters all = allocTotals();
+    std::vector<size_t> kinds;
+    for (size_t t = 0; t < NODE_TYPES; ++t) {
+        if (nodes[t].allocations.load()) kinds.push_back(t);
+    }
+    std::sort(kinds.begin(), kinds.end(), [](size_t a, size_t b) { return nodes[a].bytes > nodes[b].bytes; });
+
+    if (json) {
+        out << "{\"allocations\": " << all.allocations << ", \"bytes\": " << all.bytes << ", \"frees\": "
+            << all.frees << ", \"peak_live_bytes\": " << all.peakLive << ", \"phases\": {";
+        bool first = true;
+        for (size_t p = 0; p < PHASES; ++p) {
+            AllocCounters c = snapshot(phases[p]);
+            if (!c.allocations && !c.frees) continue;
+            out << (first ? "" : ", ") << '"' << phaseTitle(p) << "\": {\"allocations\": " << c.allocations
+                << ", \"bytes\": " << c.bytes << ", \"frees\": " << c.frees << ", \"freed_bytes\": "
+                << c.freedBytes << ", \"peak_live_bytes\": " << c.peakLive << "}";
+            first = false;
+        }
+        out << "}, \"nodes\": {";
+        for (size_t i = 0; i < kinds.size(); ++i) {
+            AllocCounters c = snapshot(nodes[kinds[i]]);
+            out << (i ? ", " : "") << '"' << astNodeTypeName(static_cast<ASTNodeType>(kinds[i]))
+                << "\": {\"allocations\": " << c.allocations << ", \"bytes\": " << c.bytes << "}";
+        }
+        out << "}}\n";
+        return;
+    }
+
+    char line[200];
+    std::snprintf(line, sizeof line, "Выделения: %llu блоков, %.1f МБ; освобождений %llu; пик живых %.1f МБ\n",
+                  static_cast<unsigned long long>(all.allocations), static_cast<double>(all.bytes) / (1 << 20),
+                  static_cast<unsigned long long>(all.frees), static_cast<double>(all.peakLive) / (1 << 20));
+    out << line;
+    std::snprintf(line, sizeof line, "  %-10s %12s %12s %12s %12s\n", "фаза", "блоков", "МБ", "освобождено",
+                  "пик МБ");
+    out << line;
+    for (size_t p = 0; p < PHASES; ++p) {
+        AllocCounters c = snapshot(phases[p]);
+        if (!c.allocations && !c.frees) continue;
+        std::snprintf(line, sizeof line, "  %-10s %12llu %12.1f %12llu %12.1f\n", phaseTitle(p),
+                      static_cast<unsigned long long>(c.allocations), static_cast<double>(c.bytes) / (1 << 20),
+                      static_cast<unsigned long long>(c.frees), static_cast<double>(c.peakLive) / (1 << 20));
+        out << line;
+    }
+    if (kinds.empty()) return;
+    std::snprintf(line, sizeof line, "  %-16s %12s %12s %10s\n", "узел", "блоков", "МБ", "байт/узел");
+    out << line;
+    for (size_t t: kinds) {
+        AllocCounters c = snapshot(nodes[t]);
+        std::snprintf(line, sizeof line, "  %-16s %12llu %12.1f %10.1f\n",
+                      astNodeTypeName(static_cast<ASTNodeType>(t)), static_cast<unsigned long long>(c.allocations),
+                      static_cast<double>(c.bytes) / (1 << 20),
+                      static_cast<double>(c.bytes) / static_cast<double>(c.allocations));
+        out << line;
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef ALLOCPROFILE_H
+#define ALLOCPROFILE_H
+
+#include "AST.h"
+#include "Stats.h"
+#include <cstdint>
+#include <ostream>
+
+// Профиль выделений памяти. AllocProfile.cpp заменяет глобальные operator
+// new/delete; замена попадает только в программы, которые ссылаются на
+// функции ниже (объектный файл тянется из библиотеки по ссылке). Пока
+// профиль не включён, цена — одна проверка флага на выделение.
+// Выделение относится к фазе текущего PhaseTimer (разбивка по фазам есть
+// только в сборке с ANALYZER_STATS) и к типу узла, который создаёт
+// Parser::makeNode. Размеры — фактические размеры блоков malloc (glibc) или
+// запрошенные (остальные платформы).
+
+struct AllocCounters {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    uint64_t frees = 0;
+    uint64_t freedBytes = 0;
+    uint64_t peakLive = 0;          // наибольший объём живых блоков во время фазы
+};
+
+// Тип узла, который сейчас создаёт парсер; -1 — не узел.
+inline thread_local int allocNodeType = -1;
+
+void enableAllocProfile(bool enabled);
+bool allocProfileEnabled();
+
+AllocCounters allocTotals();
+int64_t allocLiveBytes();
+AllocCounters allocPhase(StatsPhase phase);     // StatsPhase::Count — вне фаз
+AllocCounters allocNodeKind(ASTNodeType type);  // только allocations и bytes
+
+void printAllocProfile(std::ostream &out, bool json);
+
+#endif
@@ -0,0 +1,171 @@
+#include "AstDumper.h"
+#include "AstVisitor.h"
+#include <string_view>
+
+namespace {
+
+void writeJsonString(OutputBuffer &out, std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    out.put('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out.append(text.substr(runStart, i - runStart));
+        runStart = i + 1;
+        switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                out.append("\\u00");
+                out.put(hex[c >> 4]);
+                out.put(hex[c & 0xf]);
+        }
+    }
+    out.append(text.substr(runStart));
+    out.put('"');
+}
+
+void writeSExprString(OutputBuffer &out, std::string_view text) {
+    out.put('"');
+    for (char c: text) {
+        if (c == '"' || c == '\\') out.put('\\');
+        out.put(c);
+    }
+    out.put('"');
+}
+
+// Узлы, которые в текстовом дереве печатаются без значения.
+bool isBareInText(ASTNodeType type) {
+    switch (type) {
+        case ASTNodeType::Program:
+        case ASTNodeType::Block:
+        case ASTNodeType::StatementBlock:
+        case ASTNodeType::IfStatement:
+        case ASTNodeType::WhileStatement:
+        case ASTNodeType::Unknown:
+            return true;
+        default:
+            return false;
+    }
+}
+
+class DumpVisitor : public AstVisitor<DumpVisitor, const ASTNode> {
+public:
+    DumpVisitor(OutputBuffer &out, DumpFormat format) : out(out), format(format) {}
+
+    bool enterNode(const ASTNode &node) {
+        switch (format) {
+            case DumpFormat::Text:
+                out.indent(depth() * 2);
+                out.append(astNodeTypeName(node.type));
+                if (!isBareInText(node.type)) {
+                    out.put(':');
+                    if (!node.value.empty()) {
+                        out.put(' ');
+                        out.append(node.value);
+                    }
+                }
+                out.put('\n');
+                break;
+            case DumpFormat::Json:
+                if (childIndex() > 0) out.put(',');
+                out.append("{\"type\":\"");
+                out.append(astNodeTypeName(node.type));
+                out.append("\",\"value\":");
+                writeJsonString(out, node.value);
+                out.append(",\"children\":[");
+                break;
+            case DumpFormat::SExpr:
+                if (depth() > 0) out.put(' ');
+                out.put('(');
+                out.append(astNodeTypeName(node.type));
+                if (!node.value.empty()) {
+                    out.put(' ');
+                    writeSExprString(out, node.value);
+                }
+                break;
+        }
+        return true;
+    }
+
+    void leaveNode(const ASTNode &) {
+        switch (format) {
+            case DumpFormat::Text:
+                break;
+            case DumpFormat::Json:
+                out.append("]}");
+                break;
+            case DumpFormat::SExpr:
+                out.put(')');
+                break;
+        }
+    }
+
+private:
+    OutputBuffer &out;
+    DumpFormat format;
+};
+
+}
+
+bool parseDumpFormat(const std::string &name, DumpFormat &format) {
+    if (name == "text") format = DumpFormat::Text;
+    else if (name == "json") format = DumpFormat::Json;
+    else if (name == "sexpr") format = DumpFormat::SExpr;
+    else return false;
+    return true;
+}
+
+void dumpTokens(OutputBuffer &out, const std::vector<Token> &tokens, DumpFormat format) {
+    switch (format) {
+        case DumpFormat::Text:
+            for (const auto &token: tokens) {
+                out.append(token.lexeme);
+                out.put(' ');
+            }
+            out.put('\n');
+            break;
+        case DumpFormat::Json:
+            out.put('[');
+            for (size_t i = 0; i < tokens.size(); ++i) {
+                const Token &token = tokens[i];
+                if (i > 0) out.put(',');
+                out.append("{\"type\":\"");
+                out.append(tokenTypeName(token.type));
+                out.append("\",\"lexeme\":");
+                writeJsonString(out, token.lexeme);
+                out.append(",\"line\":");
+                out.number(static_cast<uint64_t>(token.line));
+                if (token.type == TokenType::NUMBER) {
+                    out.append(",\"value\":");
+                    out.number(token.value);
+                }
+                out.put('}');
+            }
+            out.append("]\n");
+            break;
+        case DumpFormat::SExpr:
+            out.append("(tokens");
+            for (const auto &token: tokens) {
+                out.append(" (");
+                out.append(tokenTypeName(token.type));
+                out.put(' ');
+                writeSExprString(out, token.lexeme);
+                out.put(' ');
+                out.number(static_cast<uint64_t>(token.line));
+                out.put(')');
+            }
+            out.append(")\n");
+            break;
+    }
+}
+
+void dumpAst(OutputBuffer &out, const ASTNode &root, DumpFormat format) {
+    DumpVisitor visitor(out, format);
+    visitor.traverse(root);
+    if (format != DumpFormat::Text) out.put('\n');
+}
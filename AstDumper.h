@@ -0,0 +1,23 @@
+#ifndef ASTDUMPER_H
+#define ASTDUMPER_H
+
+#include "AST.h"
+#include "Lexer.h"
+#include "OutputBuffer.h"
+#include <string>
+#include <vector>
+
+enum class DumpFormat {
+    Text,   // дерево с отступами, как в README
+    Json,
+    SExpr
+};
+
+bool parseDumpFormat(const std::string &name, DumpFormat &format);
+
+// Вывод идёт потоком в OutputBuffer: память не зависит от размера дерева,
+// обход итеративный, поэтому глубина вложенности не ограничена стеком.
+void dumpTokens(OutputBuffer &out, const std::vector<Token> &tokens, DumpFormat format);
+void dumpAst(OutputBuffer &out, const ASTNode &root, DumpFormat format);
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef ASTVISITOR_H
+#define ASTVISITOR_H
+
+#include "AST.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Список видов узлов для генерации обработчиков. Должен совпадать с ASTNodeType.
+#define AST_NODE_KINDS(X) \
+    X(Program)            \
+    X(Block)              \
+    X(ConstDecl)          \
+    X(VarDecl)            \
+    X(TemplateDecl)       \
+    X(ClassDecl)          \
+    X(StatementBlock)     \
+    X(Assignment)         \
+    X(IfStatement)        \
+    X(WhileStatement)     \
+    X(ProcedureCall)      \
+    X(Expression)         \
+    X(Term)               \
+    X(Factor)             \
+    X(Unknown)            \
+    X(END)
+
+#define AST_COUNT_KIND(Kind) +1
+static_assert(0 AST_NODE_KINDS(AST_COUNT_KIND) == static_cast<int>(ASTNodeType::END) + 1,
+              "AST_NODE_KINDS не совпадает с ASTNodeType");
+#undef AST_COUNT_KIND
+
+// Обход AST со статической диспетчеризацией (CRTP). Наследник переопределяет
+// только нужные обработчики:
+//   bool enterWhileStatement(Node &node);   // false — не заходить в детей
+//   void leaveWhileStatement(Node &node);
+// либо общие enterNode/leaveNode для всех видов сразу. Виртуальных вызовов нет,
+// обход итеративный с явным стеком, поэтому глубина дерева не ограничена
+// стеком вызовов. Node может быть const ASTNode для анализов только на чтение.
+template <typename Derived, typename Node = ASTNode>
+class AstVisitor {
+public:
+    void traverse(Node &root) {
+        stack.clear();
+        if (!enter(root)) {
+            leave(root);
+            return;
+        }
+        stack.push_back({&root, 0});
+        while (!stack.empty()) {
+            Frame &frame = stack.back();
+            if (frame.nextChild == frame.node->children.size()) {
+                Node *done = frame.node;
+                stack.pop_back();
+                leave(*done);
+                continue;
+            }
+            Node &child = *frame.node->children[frame.nextChild++];
+            if (enter(child)) {
+                stack.push_back({&child, 0});
+            } else {
+                leave(child);
+            }
+        }
+    }
+
+    bool enterNode(Node &) { return true; }
+
+    void leaveNode(Node &) {}
+
+#define AST_DECLARE_HOOKS(Kind)                                               \
+    bool enter##Kind(Node &node) { return derived().enterNode(node); }       \
+    void leave##Kind(Node &node) { derived().leaveNode(node); }
+    AST_NODE_KINDS(AST_DECLARE_HOOKS)
+#undef AST_DECLARE_HOOKS
+
+protected:
+    // Глубина узла, обрабатываемого в enter/leave (у корня — 0).
+    size_t depth() const { return stack.size(); }
+
+    // Родитель текущего узла или nullptr для корня.
+    Node *parent() const { return stack.empty() ? nullptr : stack.back().node; }
+
+    // Номер текущего узла среди детей родителя (в enter/leave).
+    size_t childIndex() const { return stack.empty() ? 0 : stack.back().nextChild - 1; }
+
+private:
+    struct Frame {
+        Node *node;
+        size_t nextChild;
+    };
+    std::vector<Frame> stack;
+
+    Derived &derived() { return static_cast<Derived &>(*this); }
+
+    bool enter(Node &node) {
+        switch (node.type) {
+#define AST_DISPATCH_ENTER(Kind) \
+            case ASTNodeType::Kind: return derived().enter##Kind(node);
+            AST_NODE_KINDS(AST_DISPATCH_ENTER)
+#undef AST_DISPATCH_ENTER
+        }
+        return derived().enterNode(node);
+    }
+
+    void leave(Node &node) {
+        switch (node.type) {
+#define AST_DISPATCH_LEAVE(Kind) \
+            case ASTNodeType::Kind: derived().leave##Kind(node); return;
+            AST_NODE_KINDS(AST_DISPATCH_LEAVE)
+#undef AST_DISPATCH_LEAVE
+        }
+        derived().leaveNode(node);
+    }
+};
+
+// Переписывание AST снизу вверх. Для каждого узла после обработки его детей
+// вызывается rewrite<Kind>(node) (по умолчанию rewriteNode), результат
+// подставляется на место узла у родителя. Возврат того же указателя оставляет
+// узел, nullptr удаляет его из списка детей. Перед спуском вызываются те же
+// enter<Kind>-обработчики, что и у AstVisitor.
+template <typename Derived>
+class AstRewriter {
+public:
+    using NodePtr = std::shared_ptr<ASTNode>;
+
+    NodePtr rewrite(NodePtr root) {
+        stack.clear();
+        NodePtr result = root;
+        if (enter(*root)) {
+            stack.push_back({&result, 0});
+            while (!stack.empty()) {
+                Frame &frame = stack.back();
+                ASTNode &node = **frame.slot;
+                if (frame.nextChild == node.children.size()) {
+                    NodePtr *slot = frame.slot;
+                    stack.pop_back();
+                    auto &children = node.children;
+                    children.erase(std::remove(children.begin(), children.end(), nullptr), children.end());
+                    *slot = apply(*slot);
+                    continue;
+                }
+                NodePtr *childSlot = &node.children[frame.nextChild++];
+                if (enter(**childSlot)) {
+                    stack.push_back({childSlot, 0});
+                } else {
+                    *childSlot = apply(*childSlot);
+                }
+            }
+        } else {
+            result = apply(result);
+        }
+        return result;
+    }
+
+    bool enterNode(ASTNode &) { return true; }
+
+    NodePtr rewriteNode(const NodePtr &node) { return node; }
+
+#define AST_DECLARE_REWRITE_HOOKS(Kind)                                                  \
+    bool enter##Kind(ASTNode &node) { return derived().enterNode(node); }               \
+    NodePtr rewrite##Kind(const NodePtr &node) { return derived().rewriteNode(node); }
+    AST_NODE_KINDS(AST_DECLARE_REWRITE_HOOKS)
+#undef AST_DECLARE_REWRITE_HOOKS
+
+protected:
+    size_t depth() const { return stack.size(); }
+
+    ASTNode *parent() const { return stack.empty() ? nullptr : stack.back().slot->get(); }
+
+private:
+    struct Frame {
+        NodePtr *slot;
+        size_t nextChild;
+    };
+    std::vector<Frame> stack;
+
+    Derived &derived() { return static_cast<Derived &>(*this); }
+
+    bool enter(ASTNode &node) {
+        switch (node.type) {
+#define AST_DISPATCH_REWRITE_ENTER(Kind) \
+            case ASTNodeType::Kind: return derived().enter##Kind(node);
+            AST_NODE_KINDS(AST_DISPATCH_REWRITE_ENTER)
+#undef AST_DISPATCH_REWRITE_ENTER
+        }
+        return derived().enterNode(node);
+    }
+
+    NodePtr apply(const NodePtr &node) {
+        switch (node->type) {
+#define AST_DISPATCH_REWRITE(Kind) \
+            case ASTNodeType::Kind: return derived().rewrite##Kind(node);
+            AST_NODE_KINDS(AST_DISPATCH_REWRITE)
+#undef AST_DISPATCH_REWRITE
+        }
+        return derived().rewriteNode(node);
+    }
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef BUILTINS_H
+#define BUILTINS_H
+
+#include "AST.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+
+// Семантика операторов: сравнения дают 1 или 0, любое ненулевое значение —
+// истина.
+inline double applyBinary(BinaryOp op, double l, double r) {
+    switch (op) {
+        case BinaryOp::Add: return l + r;
+        case BinaryOp::Sub: return l - r;
+        case BinaryOp::Mul: return l * r;
+        case BinaryOp::Div: return l / r;
+        case BinaryOp::Lt: return l < r;
+        case BinaryOp::Gt: return l > r;
+        case BinaryOp::Le: return l <= r;
+        case BinaryOp::Ge: return l >= r;
+        case BinaryOp::Eq: return l == r;
+        case BinaryOp::Ne: return l != r;
+        case BinaryOp::Invalid: break;
+    }
+    return 0.0;
+}
+
+// Встроенные процедуры (операторы-вызовы).
+enum class Procedure {
+    Write,
+    Writeln,
+    Readln,
+    Assert
+};
+
+inline bool findProcedure(const std::string &name, Procedure &procedure) {
+    if (name == "write") procedure = Procedure::Write;
+    else if (name == "writeln") procedure = Procedure::Writeln;
+    else if (name == "readln") procedure = Procedure::Readln;
+    else if (name == "assert") procedure = Procedure::Assert;
+    else return false;
+    return true;
+}
+
+// Встроенные числовые функции языка. Чистая функция зависит только от
+// аргумента и не имеет побочных эффектов: её вызов можно свернуть, вынести из
+// цикла или вычислить один раз. Процедуры (write, readln, ...) — операторы и
+// в выражениях не встречаются.
+struct Builtin {
+    const char *name;
+    double (*fn)(double);
+    bool keepsInteger;      // от целого аргумента — целый результат, иначе real
+    bool pure;
+};
+
+inline double builtinAbs(double x) { return std::fabs(x); }
+inline double builtinSin(double x) { return std::sin(x); }
+inline double builtinCos(double x) { return std::cos(x); }
+inline double builtinSqrt(double x) { return std::sqrt(x); }
+inline double builtinExp(double x) { return std::exp(x); }
+inline double builtinLn(double x) { return std::log(x); }
+inline double builtinArctan(double x) { return std::atan(x); }
+
+inline const Builtin BUILTINS[] = {
+        {"abs", builtinAbs, true, true},
+        {"sin", builtinSin, false, true},
+        {"cos", builtinCos, false, true},
+        {"sqrt", builtinSqrt, false, true},
+        {"exp", builtinExp, false, true},
+        {"ln", builtinLn, false, true},
+        {"arctan", builtinArctan, false, true},
+};
+
+inline const Builtin *findBuiltin(const std::string &name) {
+    for (const auto &builtin: BUILTINS) {
+        if (name == builtin.name) return &builtin;
+    }
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,253 @@
+#include "Bytecode.h"
+#include "Builtins.h"
+#include "Peephole.h"
+#include "Resolver.h"
+#include "TypeChecker.h"
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+const char *opCodeName(OpCode op) {
+    switch (op) {
+        case OpCode::PushConst: return "PUSH_CONST";
+        case OpCode::Load: return "LOAD";
+        case OpCode::Store: return "STORE";
+        case OpCode::Add: return "ADD";
+        case OpCode::Sub: return "SUB";
+        case OpCode::Mul: return "MUL";
+        case OpCode::Div: return "DIV";
+        case OpCode::Lt: return "LT";
+        case OpCode::Gt: return "GT";
+        case OpCode::Le: return "LE";
+        case OpCode::Ge: return "GE";
+        case OpCode::Eq: return "EQ";
+        case OpCode::Ne: return "NE";
+        case OpCode::CallBuiltin: return "CALL_BUILTIN";
+        case OpCode::Jump: return "JUMP";
+        case OpCode::JumpIfFalse: return "JUMP_IF_FALSE";
+        case OpCode::JumpIfTrue: return "JUMP_IF_TRUE";
+        case OpCode::WriteNumber: return "WRITE_NUMBER";
+        case OpCode::WriteString: return "WRITE_STRING";
+        case OpCode::Newline: return "NEWLINE";
+        case OpCode::Read: return "READ";
+        case OpCode::Assert: return "ASSERT";
+        case OpCode::Halt: return "HALT";
+        case OpCode::LoadLoad: return "LOAD_LOAD";
+        case OpCode::LoadLoadAdd: return "LOAD_LOAD_ADD";
+        case OpCode::LoadLoadSub: return "LOAD_LOAD_SUB";
+        case OpCode::LoadLoadMul: return "LOAD_LOAD_MUL";
+        case OpCode::StoreLoad: return "STORE_LOAD";
+        case OpCode::Move: return "MOVE";
+        case OpCode::AddConst: return "ADD_CONST";
+        case OpCode::SubConst: return "SUB_CONST";
+        case OpCode::MulConst: return "MUL_CONST";
+        case OpCode::DivConst: return "DIV_CONST";
+        case OpCode::CmpJumpIfFalse: return "CMP_JUMP_IF_FALSE";
+        case OpCode::CmpJumpIfTrue: return "CMP_JUMP_IF_TRUE";
+        case OpCode::IncSlot: return "INC_SLOT";
+        case OpCode::Count: break;
+    }
+    return "?";
+}
+
+namespace {
+
+class BytecodeCompiler {
+public:
+    explicit BytecodeCompiler(Chunk &chunk) : chunk(chunk) {}
+
+    void statement(const ASTNode &node) {
+        switch (node.type) {
+            case ASTNodeType::Program:
+            case ASTNodeType::Block:
+            case ASTNodeType::StatementBlock:
+                for (const auto &child: node.children) {
+                    statement(*child);
+                }
+                return;
+            case ASTNodeType::VarDecl: {
+                // Объявление без инициализатора записывает ноль, как в
+                // интерпретаторе AST.
+                if (node.children.empty()) {
+                    emit(OpCode::PushConst, constant(0.0));
+                    push();
+                } else {
+                    expression(*node.children[0]);
+                }
+                store(node.slot);
+                size_t count = declaredNames(node).size();
+                for (size_t i = 1; i < count; ++i) {
+                    emit(OpCode::Load, node.slot);
+                    push();
+                    store(node.slot + i);
+                }
+                return;
+            }
+            case ASTNodeType::Assignment:
+                expression(*node.children[0]);
+                store(node.slot);
+                return;
+            case ASTNodeType::IfStatement: {
+                expression(*node.children[0]);
+                size_t skipThen = emit(OpCode::JumpIfFalse);
+                --depth;
+                statement(*node.children[1]);
+                if (node.children.size() > 2) {
+                    size_t skipElse = emit(OpCode::Jump);
+                    patch(skipThen);
+                    statement(*node.children[2]);
+                    patch(skipElse);
+                } else {
+                    patch(skipThen);
+                }
+                return;
+            }
+            case ASTNodeType::WhileStatement: {
+                // Условие проверяется внизу: одна команда перехода на итерацию.
+                size_t toCondition = emit(OpCode::Jump);
+                size_t body = chunk.code.size();
+                statement(*node.children[1]);
+                patch(toCondition);
+                expression(*node.children[0]);
+                emit(OpCode::JumpIfTrue, body);
+                --depth;
+                return;
+            }
+            case ASTNodeType::ProcedureCall:
+                procedureCall(node);
+                return;
+            default:
+                return;
+        }
+    }
+
+private:
+    Chunk &chunk;
+    size_t depth = 0;
+    std::unordered_map<uint64_t, uint32_t> constantIndex;
+
+    size_t emit(OpCode op, size_t a = 0) {
+        chunk.code.push_back({op, static_cast<uint32_t>(a)});
+        return chunk.code.size() - 1;
+    }
+
+    void patch(size_t jump) {
+        chunk.code[jump].a = static_cast<uint32_t>(chunk.code.size());
+    }
+
+    void push() {
+        if (++depth > chunk.maxStack) chunk.maxStack = depth;
+    }
+
+    void store(size_t slot) {
+        emit(OpCode::Store, slot);
+        --depth;
+    }
+
+    uint32_t constant(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        auto it = constantIndex.find(bits);
+        if (it != constantIndex.end()) return it->second;
+        auto index = static_cast<uint32_t>(chunk.constants.size());
+        chunk.constants.push_back(value);
+        constantIndex.emplace(bits, index);
+        return index;
+    }
+
+    void expression(const ASTNode &node) {
+        switch (node.type) {
+            case ASTNodeType::Expression:
+            case ASTNodeType::Term: {
+                BinaryOp op = binaryOp(node.value);
+                if (op == BinaryOp::Invalid) break;
+                expression(*node.children[0]);
+                expression(*node.children[1]);
+                emit(static_cast<OpCode>(static_cast<int>(OpCode::Add) + static_cast<int>(op)));
+                --depth;
+                return;
+            }
+            case ASTNodeType::Factor:
+                switch (node.factor) {
+                    case FactorKind::Number:
+                        emit(OpCode::PushConst, constant(node.number));
+                        push();
+                        return;
+                    case FactorKind::Name:
+                        emit(OpCode::Load, node.slot);
+                        push();
+                        return;
+                    case FactorKind::Call:
+                        expression(*node.children[0]);
+                        emit(OpCode::CallBuiltin, node.slot);
+                        return;
+                    default:
+                        break;
+                }
+                break;
+            default:
+                break;
+        }
+        throw std::runtime_error("Невычислимое выражение: " + node.value);
+    }
+
+    void procedureCall(const ASTNode &node) {
+        switch (static_cast<Procedure>(node.slot)) {
+            case Procedure::Write:
+            case Procedure::Writeln:
+                for (const auto &arg: node.children) {
+                    if (arg->type == ASTNodeType::Factor && arg->factor == FactorKind::String) {
+                        emit(OpCode::WriteString, chunk.strings.size());
+                        chunk.strings.push_back(arg->value);
+                    } else {
+                        expression(*arg);
+                        emit(OpCode::WriteNumber);
+                        --depth;
+                    }
+                }
+                if (static_cast<Procedure>(node.slot) == Procedure::Writeln) emit(OpCode::Newline);
+                return;
+            case Procedure::Readln:
+                for (const auto &arg: node.children) {
+                    size_t read = emit(OpCode::Read, arg->slot);
+                    chunk.code[read].b = arg->valueType == ValueType::Integer;
+                }
+                return;
+            case Procedure::Assert:
+                for (const auto &arg: node.children) {
+                    expression(*arg);
+                    emit(OpCode::Assert);
+                    --depth;
+                }
+                return;
+        }
+    }
+};
+
+}
+
+static_assert(static_cast<int>(OpCode::Ne) - static_cast<int>(OpCode::Add) ==
+              static_cast<int>(BinaryOp::Ne) - static_cast<int>(BinaryOp::Add),
+              "порядок арифметических команд должен совпадать с BinaryOp");
+
+Chunk compileProgram(ASTNode &program, bool superinstructions) {
+    Resolution resolution = resolveNames(program);
+    checkTypes(program, resolution);
+    Chunk chunk = compileStatement(program, resolution.frameSize, superinstructions);
+    chunk.initialFrame = std::move(resolution.initialFrame);
+    return chunk;
+}
+
+Chunk compileStatement(const ASTNode &statement, size_t frameSize, bool superinstructions) {
+    Chunk chunk;
+    chunk.frameSize = frameSize;
+    BytecodeCompiler compiler(chunk);
+    compiler.statement(statement);
+    if (statement.type == ASTNodeType::WhileStatement) {
+        // Цикл компилируется как Jump на условие и тело сразу за ним.
+        chunk.loopBody = 1;
+    }
+    chunk.code.push_back({OpCode::Halt, 0});
+    if (superinstructions) fuseSuperinstructions(chunk);
+    return chunk;
+}
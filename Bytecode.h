@@ -0,0 +1,79 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include "AST.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Команды стековой машины. Операнд a — индекс в пуле констант или строк,
+// номер ячейки кадра, номер встроенной функции или адрес перехода.
+enum class OpCode : uint8_t {
+    PushConst,      // стек <- constants[a]
+    Load,           // стек <- frame[a]
+    Store,          // frame[a] <- стек
+    Add, Sub, Mul, Div,
+    Lt, Gt, Le, Ge, Eq, Ne,
+    CallBuiltin,    // x <- BUILTINS[a].fn(x)
+    Jump,           // ip <- a
+    JumpIfFalse,    // снимает условие, переход при 0
+    JumpIfTrue,     // снимает условие, переход при != 0
+    WriteNumber,    // снимает число и печатает
+    WriteString,    // печатает strings[a]
+    Newline,
+    Read,           // frame[a] <- число из входа; b != 0 — только целое
+    Assert,         // снимает условие, ошибка при 0
+    Halt,
+    // Суперинструкции (см. Peephole.h); b — второй операнд.
+    LoadLoad,       // стек <- frame[a], frame[b]
+    LoadLoadAdd,    // стек <- frame[a] + frame[b]
+    LoadLoadSub,
+    LoadLoadMul,
+    StoreLoad,      // frame[a] <- вершина, вершина <- frame[b]
+    Move,           // frame[b] <- frame[a]
+    AddConst,       // вершина <- вершина + constants[a]
+    SubConst,
+    MulConst,
+    DivConst,
+    CmpJumpIfFalse, // снимает два числа, сравнение b (BinaryOp), переход при 0
+    CmpJumpIfTrue,  // то же, переход при 1
+    IncSlot,        // frame[a] <- frame[a] + constants[b]
+    Count
+};
+
+const char *opCodeName(OpCode op);
+
+// true для команд с адресом перехода в операнде a.
+inline bool isJump(OpCode op) {
+    return op == OpCode::Jump || op == OpCode::JumpIfFalse || op == OpCode::JumpIfTrue ||
+           op == OpCode::CmpJumpIfFalse || op == OpCode::CmpJumpIfTrue;
+}
+
+struct Instruction {
+    OpCode op;
+    uint32_t a = 0;
+    uint32_t b = 0;     // второй операнд суперинструкций
+};
+
+struct Chunk {
+    std::vector<Instruction> code;
+    std::vector<double> constants;
+    std::vector<std::string> strings;
+    size_t maxStack = 0;            // наибольшая глубина стека операндов
+    size_t frameSize = 0;
+    std::vector<double> initialFrame;
+    // Для фрагмента-цикла: адрес начала тела, куда ведёт обратный переход
+    // внешнего цикла. Остановка на нём — остановка в заголовке цикла.
+    uint32_t loopBody = UINT32_MAX;
+};
+
+// Разрешает имена программы и переводит её в байткод. С superinstructions
+// частые последовательности команд сливаются (см. Peephole.h).
+Chunk compileProgram(ASTNode &program, bool superinstructions = true);
+
+// Переводит отдельный оператор уже разрешённой программы (например, цикл
+// while) в самостоятельный фрагмент, работающий с тем же кадром.
+Chunk compileStatement(const ASTNode &statement, size_t frameSize, bool superinstructions = true);
+
+#endif
@@ -0,0 +1,277 @@
+#include "Cfg.h"
+#include "Builtins.h"
+
+namespace {
+
+class CfgBuilder {
+public:
+    explicit CfgBuilder(Cfg &cfg) : cfg(cfg) {}
+
+    void build(const ASTNode &program) {
+        cfg.entry = newBlock();
+        enter(cfg.entry);
+        statement(program);
+        cfg.exit = newBlock();
+        jump(current, cfg.exit);
+        enter(cfg.exit);
+        cfg.accessStart.push_back(static_cast<uint32_t>(cfg.accesses.size()));
+        linkPredecessors();
+    }
+
+private:
+    Cfg &cfg;
+    uint32_t current = 0;
+
+    uint32_t newBlock() {
+        cfg.blocks.emplace_back();
+        return static_cast<uint32_t>(cfg.blocks.size() - 1);
+    }
+
+    // Блок становится текущим один раз, поэтому его операторы идут подряд.
+    void enter(uint32_t block) {
+        current = block;
+        cfg.blocks[block].firstStatement = static_cast<uint32_t>(cfg.statements.size());
+    }
+
+    void jump(uint32_t from, uint32_t to) {
+        cfg.blocks[from].successors[0] = static_cast<int32_t>(to);
+    }
+
+    void branch(const ASTNode &node, uint32_t ifTrue, uint32_t ifFalse) {
+        append(node);
+        uses(*node.children[0]);
+        BasicBlock &block = cfg.blocks[current];
+        block.branch = &node;
+        block.successors[0] = static_cast<int32_t>(ifTrue);
+        block.successors[1] = static_cast<int32_t>(ifFalse);
+    }
+
+    void append(const ASTNode &node) {
+        cfg.accessStart.push_back(static_cast<uint32_t>(cfg.accesses.size()));
+        cfg.statements.push_back(&node);
+        ++cfg.blocks[current].statementCount;
+    }
+
+    void write(const ASTNode &node, int slot) {
+        cfg.accesses.push_back({static_cast<uint32_t>(slot), true, &node});
+    }
+
+    void uses(const ASTNode &expression) {
+        if (expression.type == ASTNodeType::Factor && expression.factor == FactorKind::Name) {
+            if (expression.slot >= 0) cfg.accesses.push_back({static_cast<uint32_t>(expression.slot), false, &expression});
+            return;
+        }
+        for (const auto &child: expression.children) {
+            uses(*child);
+        }
+    }
+
+    void statement(const ASTNode &node) {
+        switch (node.type) {
+            case ASTNodeType::Program:
+            case ASTNodeType::Block:
+            case ASTNodeType::StatementBlock:
+                for (const auto &child: node.children) {
+                    statement(*child);
+                }
+                return;
+            case ASTNodeType::ConstDecl:
+                if (node.slot >= 0) {
+                    append(node);
+                    write(node, node.slot);
+                }
+                for (const auto &child: node.children) {
+                    if (child->type == ASTNodeType::ConstDecl) statement(*child);
+                }
+                return;
+            case ASTNodeType::VarDecl:
+                // Объявление без инициализатора обнуляет переменные, но для
+                // анализов записью не считается: иначе пропали бы
+                // предупреждения о чтении до присваивания. Пропущенная запись
+                // нуля только добавляет достигающие значения, так что SSA и
+                // удаление мёртвых записей остаются консервативными.
+                if (node.children.empty() || node.slot < 0) return;
+                append(node);
+                uses(*node.children[0]);
+                for (size_t i = 0, n = declaredNames(node).size(); i < n; ++i) {
+                    write(node, node.slot + static_cast<int>(i));
+                }
+                return;
+            case ASTNodeType::Assignment:
+                append(node);
+                uses(*node.children[0]);
+                write(node, node.slot);
+                return;
+            case ASTNodeType::ProcedureCall:
+                append(node);
+                for (const auto &arg: node.children) {
+                    if (static_cast<Procedure>(node.slot) == Procedure::Readln) {
+                        write(node, arg->slot);
+                    } else {
+                        uses(*arg);
+                    }
+                }
+                return;
+            case ASTNodeType::IfStatement: {
+                uint32_t thenBlock = newBlock();
+                uint32_t elseBlock = node.children.size() > 2 ? newBlock() : 0;
+                uint32_t join = newBlock();
+                branch(node, thenBlock, node.children.size() > 2 ? elseBlock : join);
+                enter(thenBlock);
+                statement(*node.children[1]);
+                jump(current, join);
+                if (node.children.size() > 2) {
+                    enter(elseBlock);
+                    statement(*node.children[2]);
+                    jump(current, join);
+                }
+                enter(join);
+                return;
+            }
+            case ASTNodeType::WhileStatement: {
+                uint32_t header = newBlock();
+                uint32_t body = newBlock();
+                uint32_t after = newBlock();
+                jump(current, header);
+                enter(header);
+                branch(node, body, after);
+                enter(body);
+                statement(*node.children[1]);
+                jump(current, header);
+                enter(after);
+                return;
+            }
+            default:
+                return;
+        }
+    }
+
+    void linkPredecessors() {
+        for (const auto &block: cfg.blocks) {
+            for (int32_t successor: block.successors) {
+                if (successor >= 0) ++cfg.blocks[successor].predecessorCount;
+            }
+        }
+        uint32_t offset = 0;
+        for (auto &block: cfg.blocks) {
+            block.firstPredecessor = offset;
+            offset += block.predecessorCount;
+            block.predecessorCount = 0;
+        }
+        cfg.predecessors.resize(offset);
+        for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+            for (int32_t successor: cfg.blocks[b].successors) {
+                if (successor < 0) continue;
+                BasicBlock &target = cfg.blocks[successor];
+                cfg.predecessors[target.firstPredecessor + target.predecessorCount++] = b;
+            }
+        }
+    }
+};
+
+}
+
+Cfg buildCfg(const ASTNode &program, size_t frameSize) {
+    Cfg cfg;
+    cfg.variables = frameSize;
+    CfgBuilder(cfg).build(program);
+    return cfg;
+}
+
+std::vector<uint32_t> reversePostorder(const Cfg &cfg) {
+    std::vector<uint32_t> order;
+    order.reserve(cfg.blocks.size());
+    std::vector<uint8_t> visited(cfg.blocks.size(), 0);
+    // Обход в глубину с явным стеком: (блок, номер следующего преемника).
+    std::vector<std::pair<uint32_t, int>> stack{{cfg.entry, 0}};
+    visited[cfg.entry] = 1;
+    while (!stack.empty()) {
+        auto &[block, next] = stack.back();
+        if (next < 2) {
+            int32_t successor = cfg.blocks[block].successors[next++];
+            if (successor >= 0 && !visited[successor]) {
+                visited[successor] = 1;
+                stack.emplace_back(static_cast<uint32_t>(successor), 0);
+            }
+            continue;
+        }
+        order.push_back(block);
+        stack.pop_back();
+    }
+    return {order.rbegin(), order.rend()};
+}
+
+Dominators buildDominators(const Cfg &cfg) {
+    size_t blocks = cfg.blocks.size();
+    Dominators result;
+    result.idom.assign(blocks, Dominators::None);
+
+    std::vector<uint32_t> order = reversePostorder(cfg);
+    std::vector<uint32_t> index(blocks, 0);
+    for (uint32_t i = 0; i < order.size(); ++i) index[order[i]] = i;
+
+    auto &idom = result.idom;
+    auto intersect = [&](uint32_t a, uint32_t b) {
+        while (a != b) {
+            while (index[a] > index[b]) a = idom[a];
+            while (index[b] > index[a]) b = idom[b];
+        }
+        return a;
+    };
+    idom[cfg.entry] = cfg.entry;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (uint32_t b: order) {
+            if (b == cfg.entry) continue;
+            const BasicBlock &block = cfg.blocks[b];
+            uint32_t candidate = Dominators::None;
+            for (const uint32_t *p = cfg.predecessorBegin(block); p != cfg.predecessorEnd(block); ++p) {
+                if (idom[*p] == Dominators::None) continue;
+                candidate = candidate == Dominators::None ? *p : intersect(*p, candidate);
+            }
+            if (candidate != idom[b]) {
+                idom[b] = candidate;
+                changed = true;
+            }
+        }
+    }
+
+    // Прямой обход дерева: дети собираются подсчётом, как предшественники.
+    std::vector<uint32_t> childStart(blocks + 1, 0), children(order.size() > 0 ? order.size() - 1 : 0);
+    for (uint32_t b: order) {
+        if (b != cfg.entry) ++childStart[idom[b] + 1];
+    }
+    for (size_t b = 0; b < blocks; ++b) childStart[b + 1] += childStart[b];
+    std::vector<uint32_t> fill(childStart.begin(), childStart.end() - 1);
+    for (uint32_t b: order) {
+        if (b != cfg.entry) children[fill[idom[b]]++] = b;
+    }
+    result.preorder.reserve(order.size());
+    std::vector<uint32_t> stack{cfg.entry};
+    while (!stack.empty()) {
+        uint32_t b = stack.back();
+        stack.pop_back();
+        result.preorder.push_back(b);
+        for (uint32_t c = childStart[b + 1]; c-- > childStart[b];) stack.push_back(children[c]);
+    }
+
+    // Граница: от каждого предшественника блока слияния вверх до его idom.
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for (uint32_t b: order) {
+        const BasicBlock &block = cfg.blocks[b];
+        if (block.predecessorCount < 2) continue;
+        for (const uint32_t *p = cfg.predecessorBegin(block); p != cfg.predecessorEnd(block); ++p) {
+            if (idom[*p] == Dominators::None) continue;
+            for (uint32_t runner = *p; runner != idom[b]; runner = idom[runner]) {
+                pairs.emplace_back(runner, b);
+            }
+        }
+    }
+    result.frontierStart.assign(blocks + 1, 0);
+    for (const auto &pair: pairs) ++result.frontierStart[pair.first + 1];
+    for (size_t b = 0; b < blocks; ++b) result.frontierStart[b + 1] += result.frontierStart[b];
+    result.frontier.resize(pairs.size());
+    fill.assign(result.frontierStart.begin(), result.frontierStart.end() - 1);
+    for (const auto &pair: pairs) result.frontier[fill[pair.first]++] = pair.second;
+    return result;
+}
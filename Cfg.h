@@ -0,0 +1,79 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "AST.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Обращение оператора к ячейке кадра: чтение (использование) или запись
+// (определение). node — узел-имя Factor для чтения, оператор для записи.
+struct Access {
+    uint32_t slot;
+    bool write;
+    const ASTNode *node;
+};
+
+// Базовый блок: непрерывный отрезок Cfg::statements и, если блок
+// заканчивается ветвлением, узел If/While — его условие считается последним
+// оператором блока.
+struct BasicBlock {
+    uint32_t firstStatement = 0;
+    uint32_t statementCount = 0;
+    const ASTNode *branch = nullptr;
+    // Без ветвления используется только successors[0]; при ветвлении
+    // [0] — условие истинно, [1] — ложно. -1 — нет преемника.
+    int32_t successors[2] = {-1, -1};
+    uint32_t firstPredecessor = 0;
+    uint32_t predecessorCount = 0;
+};
+
+// Граф потока управления разрешённой программы. Все данные лежат в
+// нескольких плоских массивах: блоки, операторы блоков подряд, обращения
+// операторов к кадру подряд, предшественники блоков подряд.
+struct Cfg {
+    std::vector<BasicBlock> blocks;
+    std::vector<const ASTNode *> statements;
+    std::vector<uint32_t> accessStart;      // обращения оператора i: [accessStart[i], accessStart[i + 1])
+    std::vector<Access> accesses;
+    std::vector<uint32_t> predecessors;
+    size_t variables = 0;                   // размер кадра
+    uint32_t entry = 0;
+    uint32_t exit = 0;
+
+    const Access *accessBegin(uint32_t statement) const { return accesses.data() + accessStart[statement]; }
+    const Access *accessEnd(uint32_t statement) const { return accesses.data() + accessStart[statement + 1]; }
+
+    const uint32_t *predecessorBegin(const BasicBlock &block) const {
+        return predecessors.data() + block.firstPredecessor;
+    }
+    const uint32_t *predecessorEnd(const BasicBlock &block) const {
+        return predecessors.data() + block.firstPredecessor + block.predecessorCount;
+    }
+};
+
+// Строит граф по программе после resolveNames. Константы — записи в
+// начальном блоке, if — ветвление с блоком слияния, while — отдельный блок
+// заголовка с проверкой условия и обратной дугой из конца тела.
+Cfg buildCfg(const ASTNode &program, size_t frameSize);
+
+// Достижимые из входа блоки в обратном постпорядке.
+std::vector<uint32_t> reversePostorder(const Cfg &cfg);
+
+// Дерево доминаторов и границы доминирования, тоже в плоских массивах.
+struct Dominators {
+    static constexpr uint32_t None = UINT32_MAX;
+
+    std::vector<uint32_t> idom;             // непосредственный доминатор; у входа — он сам, у недостижимых — None
+    std::vector<uint32_t> preorder;         // достижимые блоки в прямом порядке обхода дерева
+    std::vector<uint32_t> frontierStart;    // граница блока b: [frontierStart[b], frontierStart[b + 1])
+    std::vector<uint32_t> frontier;
+
+    const uint32_t *frontierBegin(uint32_t block) const { return frontier.data() + frontierStart[block]; }
+    const uint32_t *frontierEnd(uint32_t block) const { return frontier.data() + frontierStart[block + 1]; }
+};
+
+// Итеративный алгоритм Купера — Харви — Кеннеди по обратному постпорядку.
+Dominators buildDominators(const Cfg &cfg);
+
+#endif
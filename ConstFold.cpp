@@ -0,0 +1,172 @@
+#include "ConstFold.h"
+#include "AstVisitor.h"
+#include "Builtins.h"
+#include "TypeChecker.h"
+#include <charconv>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+using NodePtr = std::shared_ptr<ASTNode>;
+
+class ConstCollector : public AstVisitor<ConstCollector, const ASTNode> {
+public:
+    std::unordered_map<std::string, const ASTNode *> values;    // литерал константы
+    std::unordered_set<std::string> mutated;
+
+    bool enterConstDecl(const ASTNode &node) {
+        if (node.children.size() == 1 && node.children[0]->isNumber()) {
+            for (const auto &name: declaredNames(node)) {
+                if (!values.emplace(name, node.children[0].get()).second) mutated.insert(name);
+            }
+        }
+        return true;
+    }
+
+    bool enterVarDecl(const ASTNode &node) {
+        for (const auto &name: declaredNames(node)) mutated.insert(name);
+        return true;
+    }
+
+    bool enterAssignment(const ASTNode &node) {
+        mutated.insert(node.value);
+        return true;
+    }
+
+    bool enterProcedureCall(const ASTNode &node) {
+        if (node.value == "readln") {
+            for (const auto &arg: node.children) mutated.insert(arg->value);
+        }
+        return true;
+    }
+};
+
+bool applyOperator(const std::string &op, double l, double r, double &result) {
+    BinaryOp code = binaryOp(op);
+    if (code == BinaryOp::Invalid) return false;
+    result = applyBinary(code, l, r);
+    // Деление на ноль и переполнение оставляем до выполнения.
+    return std::isfinite(result);
+}
+
+class ConstFolder : public AstRewriter<ConstFolder> {
+public:
+    ConstFolder(const ConstCollector &constants, ConstFoldStats &stats)
+            : constants(constants), stats(stats) {}
+
+    bool enterConstDecl(ASTNode &) { return false; }
+
+    // Аргументы readln — приёмники значений, а не выражения.
+    bool enterProcedureCall(ASTNode &node) { return node.value != "readln"; }
+
+    NodePtr rewriteFactor(const NodePtr &node) {
+        if (node->factor == FactorKind::Name) {
+            auto it = constants.values.find(node->value);
+            if (it == constants.values.end() || constants.mutated.count(node->value)) return node;
+            ++stats.propagated;
+            auto literal = std::make_shared<ASTNode>(*it->second);
+            literal->valueType = literalType(*it->second);
+            return literal;
+        }
+        if (node->factor == FactorKind::Call && node->children.size() == 1 && node->children[0]->isNumber()) {
+            const Builtin *builtin = findBuiltin(node->value);
+            if (!builtin || !builtin->pure) return node;
+            double result = builtin->fn(node->children[0]->number);
+            if (!std::isfinite(result)) return node;
+            ++stats.folded;
+            return makeLiteral(result, builtinResultType(*builtin, literalType(*node->children[0])));
+        }
+        return node;
+    }
+
+    NodePtr rewriteExpression(const NodePtr &node) { return foldBinary(node); }
+
+    NodePtr rewriteTerm(const NodePtr &node) { return foldBinary(node); }
+
+    NodePtr rewriteIfStatement(const NodePtr &node) {
+        if (node->children.size() < 2 || !node->children[0]->isNumber()) return node;
+        bool taken = node->children[0]->number != 0;
+        if (taken && node->children.size() > 2 && declaresIntoEnclosingBlock(node->children[2])) return node;
+        if (!taken && declaresIntoEnclosingBlock(node->children[1])) return node;
+        ++stats.prunedBranches;
+        if (taken) return node->children[1];
+        if (node->children.size() > 2) return node->children[2];
+        return makeEmptyStatement();
+    }
+
+    NodePtr rewriteWhileStatement(const NodePtr &node) {
+        if (node->children.size() < 2 || !node->children[0]->isNumber() || node->children[0]->number != 0 ||
+            declaresIntoEnclosingBlock(node->children[1])) {
+            return node;
+        }
+        ++stats.prunedBranches;
+        return makeEmptyStatement();
+    }
+
+private:
+    const ConstCollector &constants;
+    ConstFoldStats &stats;
+
+    NodePtr foldBinary(const NodePtr &node) {
+        if (node->children.size() != 2) return node;
+        const ASTNode &left = *node->children[0];
+        const ASTNode &right = *node->children[1];
+        double result;
+        if (!left.isNumber() || !right.isNumber() || !applyOperator(node->value, left.number, right.number, result)) {
+            return node;
+        }
+        ++stats.folded;
+        return makeLiteral(result, binaryResultType(binaryOp(node->value), literalType(left), literalType(right)));
+    }
+};
+
+}
+
+std::shared_ptr<ASTNode> makeLiteral(double value, ValueType type) {
+    auto node = std::make_shared<ASTNode>(ASTNodeType::Factor, formatNumber(value));
+    node->factor = FactorKind::Number;
+    node->number = value;
+    node->valueType = type;
+    return node;
+}
+
+std::shared_ptr<ASTNode> makeEmptyStatement() {
+    return std::make_shared<ASTNode>(ASTNodeType::Unknown, "EmptyStatement");
+}
+
+bool declaresIntoEnclosingBlock(const std::shared_ptr<ASTNode> &branch) {
+    switch (branch->type) {
+        case ASTNodeType::VarDecl:
+            return true;
+        case ASTNodeType::IfStatement:
+        case ASTNodeType::WhileStatement:
+            for (size_t i = 1; i < branch->children.size(); ++i) {
+                if (declaresIntoEnclosingBlock(branch->children[i])) return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+std::string formatNumber(double value) {
+    // Десятичная запись, как в исходниках; экспонента — только для очень
+    // больших и очень маленьких чисел.
+    char buffer[64];
+    auto res = std::to_chars(buffer, buffer + sizeof buffer, value, std::chars_format::fixed);
+    if (res.ec != std::errc()) {
+        res = std::to_chars(buffer, buffer + sizeof buffer, value);
+    }
+    return std::string(buffer, res.ptr);
+}
+
+ConstFoldStats foldConstants(std::shared_ptr<ASTNode> &root) {
+    ConstFoldStats stats;
+    ConstCollector constants;
+    constants.traverse(*root);
+    ConstFolder folder(constants, stats);
+    root = folder.rewrite(root);
+    return stats;
+}
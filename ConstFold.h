@@ -0,0 +1,37 @@
+#ifndef CONSTFOLD_H
+#define CONSTFOLD_H
+
+#include "AST.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+struct ConstFoldStats {
+    size_t propagated = 0;      // имён констант заменено литералами
+    size_t folded = 0;          // подвыражений свёрнуто в литерал
+    size_t prunedBranches = 0;  // if/while с постоянным условием
+};
+
+// Подставляет значения из const-объявлений вместо имён, сворачивает
+// постоянные подвыражения (арифметика, сравнения, чистые встроенные функции)
+// в один литерал Factor и упрощает if/while с постоянным условием.
+// Константа, имя которой где-либо переобъявлено или присваивается, не
+// подставляется.
+ConstFoldStats foldConstants(std::shared_ptr<ASTNode> &root);
+
+// Литерал Factor, который помнит тип выражения, из которого получен: 2*1.5 -> 3
+// остаётся real, хотя и записан без точки.
+std::shared_ptr<ASTNode> makeLiteral(double value, ValueType type);
+
+std::shared_ptr<ASTNode> makeEmptyStatement();
+
+// Ветвь if/while без begin/end, которая сама является объявлением или
+// содержит его во вложенных if/while без begin/end: имя живёт в объемлющем
+// блоке. Такую ветвь нельзя выбросить (имя перестанет разрешаться) и нельзя
+// заворачивать в блок; оставшаяся ветвь подставляется на место if как есть.
+bool declaresIntoEnclosingBlock(const std::shared_ptr<ASTNode> &branch);
+
+// Кратчайшая запись числа, которая читается обратно без потерь.
+std::string formatNumber(double value);
+
+#endif
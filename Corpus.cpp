@@ -0,0 +1,277 @@
+#include "Corpus.h"
+#include "Builtins.h"
+#include "Lexer.h"
+#include <iterator>
+#include <sstream>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// splitmix64: один и тот же поток чисел на любой платформе и стандартной
+// библиотеке, в отличие от распределений <random>.
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    size_t below(size_t n) {
+        return static_cast<size_t>(next() % n);
+    }
+
+    bool chance(double p) {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53 < p;
+    }
+
+    template <typename T>
+    const T &pick(const std::vector<T> &items) {
+        return items[below(items.size())];
+    }
+
+private:
+    uint64_t state;
+};
+
+const std::vector<std::string> CYRILLIC_WORDS{
+        "Введите", "числа", "корень", "функции", "равен", "значение", "шаг", "итерация",
+        "результат", "сумма", "отрезок", "точность", "ошибка", "найдено"};
+const std::vector<std::string> ASCII_WORDS{
+        "value", "step", "result", "sum", "root", "error", "done", "iteration", "x", "delta"};
+const std::vector<std::string> CONSONANTS{"b", "d", "f", "g", "k", "l", "m", "n", "p", "r", "s", "t", "v", "z"};
+const std::vector<std::string> VOWELS{"a", "e", "i", "o", "u"};
+const std::vector<std::string> ADDITIVE{"+", "-"};
+const std::vector<std::string> MULTIPLICATIVE{"*", "/"};
+const std::vector<std::string> COMPARISONS{"<", ">", "<=", ">=", "=", "<>"};
+
+class CorpusWriter {
+public:
+    CorpusWriter(const CorpusOptions &options, std::ostream &out)
+            : options(options), out(out), rng(options.seed) {}
+
+    void program() {
+        vocabulary();
+        if (!constants.empty()) {
+            emit("const");
+            for (size_t i = 0; i < constants.size(); ++i) {
+                emit(" " + constants[i] + " = " + literal() + ";");
+            }
+            emit("\n");
+        }
+        emit("var ");
+        for (size_t i = 0; i < globals.size(); ++i) {
+            emit(globals[i]);
+            emit(i % 10 == 9 ? ",\n    " : ", ");
+        }
+        for (size_t i = 0; i <= options.depth; ++i) {
+            emit(counter(i) + (i < options.depth ? ", " : ": real;\n"));
+        }
+        if (options.templates) emit("template <typename T>\n");
+        emit("begin\n");
+        // Локальные объявляются только во вложенных блоках: на верхнем
+        // уровне их область не закрылась бы до конца корпуса.
+        do {
+            statement(1, 0, false);
+        } while (written < options.bytes);
+        emit("end.\n");
+        flush();
+    }
+
+private:
+    const CorpusOptions &options;
+    std::ostream &out;
+    Rng rng;
+    std::string buffer;
+    size_t written = 0;
+
+    std::vector<std::string> globals;
+    std::vector<std::string> constants;
+    std::vector<std::string> readable;         // глобальные, константы, счётчики и видимые локальные
+    std::vector<std::string> writable;         // глобальные и видимые локальные типа real
+    size_t nextLocal = 0;
+    size_t loops = 0;
+
+    void emit(std::string_view text) {
+        buffer += text;
+        written += text.size();
+        if (buffer.size() >= (64 << 10)) flush();
+    }
+
+    void flush() {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+    void indent(size_t level) {
+        emit(std::string(level * 2, ' '));
+    }
+
+    static std::string counter(size_t level) {
+        return "i" + std::to_string(level);
+    }
+
+    // Слоги «согласная + гласная»: не совпадают ни со счётчиками iN и
+    // локальными tN, ни (после проверки) с ключевыми словами и функциями.
+    void vocabulary() {
+        std::unordered_set<std::string> used;
+        auto name = [&] {
+            for (;;) {
+                std::string word;
+                for (size_t i = 0, n = 2 + rng.below(2); i < n; ++i) word += rng.pick(CONSONANTS) + rng.pick(VOWELS);
+                if (used.count(word)) word += std::to_string(used.size());
+                if (keywordType(word) != TokenType::IDENT || findBuiltin(word) || used.count(word)) continue;
+                used.insert(word);
+                return word;
+            }
+        };
+        for (size_t i = 0; i < std::max<size_t>(options.vocabulary, 1); ++i) globals.push_back(name());
+        for (size_t i = 0, n = 1 + rng.below(3); i < n; ++i) constants.push_back(name());
+        readable = globals;
+        readable.insert(readable.end(), constants.begin(), constants.end());
+        for (size_t i = 0; i <= options.depth; ++i) readable.push_back(counter(i));
+        writable = globals;
+    }
+
+    std::string literal() {
+        std::string text = std::to_string(rng.below(100));
+        if (rng.chance(options.realLiterals)) text += "." + std::to_string(1 + rng.below(999));
+        return text;
+    }
+
+    std::string text() {
+        bool cyrillic = rng.chance(options.cyrillic);
+        const auto &words = cyrillic ? CYRILLIC_WORDS : ASCII_WORDS;
+        std::string result = "'" + rng.pick(words);
+        for (size_t i = 0, n = rng.below(3); i < n; ++i) result += " " + rng.pick(words);
+        return result + (rng.chance(0.5) ? ": '" : " = '");
+    }
+
+    std::string leaf() {
+        return rng.chance(options.literals) ? literal() : rng.pick(readable);
+    }
+
+    // Выражение без сравнений: сравнение — только на верхнем уровне условия.
+    std::string expression(size_t depth) {
+        if (depth >= options.expressionDepth || rng.chance(0.35)) return leaf();
+        size_t r = rng.below(10);
+        if (r < 2) return BUILTINS[rng.below(std::size(BUILTINS))].name + std::string("(") + expression(depth + 1) + ")";
+        if (r < 4) return "(" + expression(depth + 1) + ")";
+        const auto &ops = r < 7 ? ADDITIVE : MULTIPLICATIVE;
+        return expression(depth + 1) + " " + rng.pick(ops) + " " + expression(depth + 1);
+    }
+
+    std::string condition() {
+        return expression(1) + " " + rng.pick(COMPARISONS) + " " + expression(1);
+    }
+
+    // inList — оператор стоит в списке begin/end, и объявление локальной
+    // переменной не выходит за свою область.
+    void statement(size_t level, size_t depth, bool inList) {
+        size_t r = rng.below(100);
+        if (depth < options.depth) {
+            if (r < 8) {
+                block(level, depth + 1, true);
+                return;
+            }
+            if (r < 20) {
+                ifStatement(level, depth + 1);
+                return;
+            }
+            if (r < 28) {
+                whileStatement(level, depth + 1);
+                return;
+            }
+        }
+        indent(level);
+        r = rng.below(100);
+        if (r < 20 && inList) {
+            std::string name = "t" + std::to_string(nextLocal++);
+            bool typed = rng.chance(0.5);
+            emit("var " + name + (typed ? " : real := " : " := ") + expression(0) + ";\n");
+            readable.push_back(name);
+            if (typed) writable.push_back(name);
+        } else if (r < 32) {
+            emit(std::string(rng.chance(0.7) ? "writeln(" : "write(") + text() + ", " + expression(0) + ");\n");
+        } else if (r < 35) {
+            std::string low = literal();
+            emit("assert(" + low + " <= " + low + " + " + literal() + ");\n");
+        } else {
+            emit(rng.pick(writable) + " := " + expression(0) + ";\n");
+        }
+    }
+
+    void block(size_t level, size_t depth, bool semicolon) {
+        indent(level);
+        emit("begin\n");
+        size_t visible = readable.size(), assignable = writable.size();
+        for (size_t i = 0, n = 1 + rng.below(4); i < n; ++i) {
+            statement(level + 1, depth, true);
+            if (written >= options.bytes) break;
+        }
+        readable.resize(visible);
+        writable.resize(assignable);
+        indent(level);
+        emit(semicolon ? "end;\n" : "end\n");
+    }
+
+    // Ветвь if: блок или простой оператор (у него своя ';', и else после
+    // неё допустим).
+    void branch(size_t level, size_t depth, bool beforeElse) {
+        if (depth < options.depth && rng.chance(0.5)) {
+            block(level, depth, !beforeElse);
+        } else {
+            statement(level + 1, options.depth, false);
+        }
+    }
+
+    void ifStatement(size_t level, size_t depth) {
+        indent(level);
+        emit("if " + condition() + " then\n");
+        bool hasElse = rng.chance(0.5);
+        branch(level, depth, hasElse);
+        if (!hasElse) return;
+        indent(level);
+        emit("else\n");
+        branch(level, depth, false);
+    }
+
+    void whileStatement(size_t level, size_t depth) {
+        std::string i = counter(loops++);
+        indent(level);
+        emit(i + " := 0;\n");
+        indent(level);
+        emit("while " + i + " < " + std::to_string(1 + rng.below(3)) + " do\n");
+        indent(level);
+        emit("begin\n");
+        size_t visible = readable.size(), assignable = writable.size();
+        for (size_t k = 0, n = 1 + rng.below(3); k < n; ++k) {
+            statement(level + 1, depth, true);
+            if (written >= options.bytes) break;
+        }
+        readable.resize(visible);
+        writable.resize(assignable);
+        indent(level + 1);
+        emit(i + " := " + i + " + 1;\n");
+        indent(level);
+        emit("end;\n");
+        --loops;
+    }
+};
+
+}
+
+void generateCorpus(const CorpusOptions &options, std::ostream &out) {
+    CorpusWriter(options, out).program();
+}
+
+std::string generateCorpus(const CorpusOptions &options) {
+    std::ostringstream out;
+    generateCorpus(options, out);
+    return out.str();
+}
@@ -0,0 +1,35 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Параметры синтетической программы.
+struct CorpusOptions {
+    size_t bytes = 64 << 10;        // примерный размер; программа закрывается сразу после него
+    uint64_t seed = 1;
+    size_t depth = 4;               // вложенность begin/if/while
+    size_t expressionDepth = 4;     // вложенность скобок и вызовов в выражении
+    size_t vocabulary = 32;         // глобальных переменных
+    double literals = 0.3;          // доля литералов среди листьев выражений
+    double realLiterals = 0.5;      // доля дробных среди числовых литералов
+    double cyrillic = 0.5;          // доля строк с кириллицей
+    bool templates = true;          // объявление template <typename T>
+};
+
+// Генератор программ по грамматике Parser: const, var и template в заголовке,
+// вложенные begin/end, if/else, while, локальные var, вызовы процедур и
+// встроенных функций, выражения со всеми уровнями приоритета. Программа не
+// только разбирается, но и проходит разрешение имён и проверку типов и
+// завершается: имена объявлены до использования, присваиваются только
+// переменные типа real, каждый while считает свой счётчик до 1..3.
+// Результат определяется только параметрами (свой ГПСЧ, без <random>), поэтому
+// вход бенчмарка воспроизводится по seed без хранения файла. Текст пишется
+// в поток кусками: гигабайтный корпус не держится в памяти целиком.
+void generateCorpus(const CorpusOptions &options, std::ostream &out);
+
+std::string generateCorpus(const CorpusOptions &options);
+
+#endif
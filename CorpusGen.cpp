@@ -0,0 +1,81 @@
+#include "Corpus.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Синтетический корпус для бенчмарков и нагрузочных проверок фронтенда.
+// corpus_gen [--size N[k|m|g]] [--seed N] [--depth N] [--expression-depth N]
+//            [--vocabulary N] [--literals P] [--real-literals P] [--cyrillic P]
+//            [--no-templates] [-o файл]
+
+namespace {
+
+size_t parseSize(const std::string &text) {
+    size_t end = 0;
+    double value = std::stod(text, &end);
+    double scale = 1;
+    if (end < text.size()) {
+        switch (text[end]) {
+            case 'k': case 'K': scale = 1 << 10; break;
+            case 'm': case 'M': scale = 1 << 20; break;
+            case 'g': case 'G': scale = 1 << 30; break;
+            default: throw std::invalid_argument(text);
+        }
+    }
+    return static_cast<size_t>(value * scale);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    CorpusOptions options;
+    std::string output;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--size" && hasValue) {
+                options.bytes = parseSize(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                options.seed = std::stoull(argv[++i]);
+            } else if (arg == "--depth" && hasValue) {
+                options.depth = std::stoul(argv[++i]);
+            } else if (arg == "--expression-depth" && hasValue) {
+                options.expressionDepth = std::stoul(argv[++i]);
+            } else if (arg == "--vocabulary" && hasValue) {
+                options.vocabulary = std::stoul(argv[++i]);
+            } else if (arg == "--literals" && hasValue) {
+                options.literals = std::stod(argv[++i]);
+            } else if (arg == "--real-literals" && hasValue) {
+                options.realLiterals = std::stod(argv[++i]);
+            } else if (arg == "--cyrillic" && hasValue) {
+                options.cyrillic = std::stod(argv[++i]);
+            } else if (arg == "--no-templates") {
+                options.templates = false;
+            } else if (arg == "-o" && hasValue) {
+                output = argv[++i];
+            } else {
+                std::cerr << "Неизвестный параметр: " << arg << std::endl;
+                return 2;
+            }
+        }
+    } catch (const std::exception &) {
+        std::cerr << "Неверное значение параметра" << std::endl;
+        return 2;
+    }
+
+    if (output.empty()) {
+        std::ios::sync_with_stdio(false);
+        generateCorpus(options, std::cout);
+        std::cout.flush();
+        return std::cout ? 0 : 1;
+    }
+    std::ofstream file(output, std::ios::binary);
+    if (!file) {
+        std::cerr << "Не удалось открыть " << output << std::endl;
+        return 1;
+    }
+    generateCorpus(options, file);
+    return file ? 0 : 1;
+}
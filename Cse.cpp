@@ -0,0 +1,395 @@
+#include "Cse.h"
+#include "AstVisitor.h"
+#include "Builtins.h"
+#include "Cfg.h"
+#include "Dataflow.h"
+#include "ExprDag.h"
+#include "Resolver.h"
+#include "TypeChecker.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+using NodePtr = std::shared_ptr<ASTNode>;
+
+constexpr uint32_t None = ExprDag::None;
+
+// Плотные строки «блоки x выражения» больше этого числа слов не строятся:
+// повторы ищутся только внутри базовых блоков.
+constexpr size_t GLOBAL_WORD_LIMIT = size_t(1) << 22;
+
+bool computed(const ASTNode &node) {
+    return node.type != ASTNodeType::Factor || node.factor == FactorKind::Call;
+}
+
+// Выражения, которые вычисляет оператор графа.
+void statementRoots(const ASTNode &statement, std::vector<const NodePtr *> &roots) {
+    roots.clear();
+    switch (statement.type) {
+        case ASTNodeType::Assignment:
+        case ASTNodeType::VarDecl:
+        case ASTNodeType::IfStatement:
+        case ASTNodeType::WhileStatement:
+            if (!statement.children.empty()) roots.push_back(&statement.children[0]);
+            return;
+        case ASTNodeType::ProcedureCall:
+            if (static_cast<Procedure>(statement.slot) == Procedure::Readln) return;
+            for (const auto &arg: statement.children) roots.push_back(&arg);
+            return;
+        default:
+            return;
+    }
+}
+
+// Объявления прямо в Block, then- или else-ветви и теле цикла: перед ними
+// некуда вставить присваивание временной, не меняя области видимости.
+void collectPinned(const ASTNode &node, std::unordered_set<const ASTNode *> &pinned) {
+    for (const auto &child: node.children) {
+        if (isExpressionNode(*child)) continue;
+        if (child->type == ASTNodeType::VarDecl && node.type != ASTNodeType::StatementBlock) {
+            pinned.insert(child.get());
+        }
+        collectPinned(*child, pinned);
+    }
+}
+
+class CseAnalysis {
+public:
+    struct Temporary {
+        std::string name;
+        ValueType type;
+    };
+
+    std::unordered_map<const ASTNode *, uint32_t> uses;         // вычисление -> временная
+    std::unordered_map<const ASTNode *, uint32_t> stores;       // вычисление, сохраняющее результат
+    // Сохранения, которые выполняются перед оператором, в порядке вычисления.
+    std::unordered_map<const ASTNode *, std::vector<const ASTNode *>> prefixes;
+    std::unordered_set<const ASTNode *> touched;                 // операторы с заменами
+    std::vector<Temporary> temporaries;
+
+    CseAnalysis(const ASTNode &program, const Resolution &resolution, CseStats &stats)
+            : cfg(buildCfg(program, resolution.frameSize)), stats(stats) {
+        collectPinned(program, pinned);
+        number();
+        selectCandidates(resolution.frameSize);
+        if (bits == 0) return;
+        std::vector<uint32_t> order = reversePostorder(cfg);
+        reachable.assign(cfg.blocks.size(), 0);
+        for (uint32_t b: order) reachable[b] = 1;
+        stats.global = cfg.blocks.size() * ((bits + 63) / 64) <= GLOBAL_WORD_LIMIT;
+        if (stats.global) available = solveDataflow(cfg, problem());
+        findRedundancies();
+    }
+
+private:
+    struct Candidate {
+        const ASTNode *node;
+        uint32_t id;
+        uint32_t statement;
+    };
+
+    Cfg cfg;
+    CseStats &stats;
+    ExprDag dag;
+    std::unordered_set<const ASTNode *> pinned;
+    std::unordered_map<const ASTNode *, uint32_t> ids;
+    std::vector<uint32_t> counts;
+    size_t bits = 0;
+    std::vector<uint32_t> bitOf;                // номер выражения -> бит или None
+    std::vector<uint32_t> killStart, kills;     // биты выражений, читающих ячейку s: [killStart[s], killStart[s + 1])
+    std::vector<uint8_t> reachable;
+    DataflowResult available;
+    std::vector<const NodePtr *> roots;
+
+    uint32_t number(const NodePtr &node) {
+        uint32_t left = None, right = None;
+        if (!node->children.empty()) left = number(node->children[0]);
+        if (node->children.size() > 1) right = number(node->children[1]);
+        uint32_t id = dag.intern(node, left, right);
+        if (id == None || !computed(*node)) return id;
+        // Имена и литералы не повторяются как вычисления: их номера нужны
+        // только родителю.
+        ids.emplace(node.get(), id);
+        if (id >= counts.size()) counts.resize(id + 1, 0);
+        ++counts[id];
+        return id;
+    }
+
+    void number() {
+        for (const ASTNode *statement: cfg.statements) {
+            statementRoots(*statement, roots);
+            for (const NodePtr *root: roots) number(*root);
+        }
+    }
+
+    uint32_t idOf(const ASTNode &node) const {
+        auto found = ids.find(&node);
+        return found == ids.end() ? None : found->second;
+    }
+
+    uint32_t bitOfNode(const ASTNode &node) const {
+        uint32_t id = idOf(node);
+        return id == None ? None : bitOf[id];
+    }
+
+    void readSlots(uint32_t id, std::vector<uint32_t> &slots) const {
+        const ExprDag::Entry &entry = dag[id];
+        if (entry.type == ASTNodeType::Factor && entry.factor == FactorKind::Name) {
+            slots.push_back(static_cast<uint32_t>(entry.slot));
+            return;
+        }
+        if (entry.left != None) readSlots(entry.left, slots);
+        if (entry.right != None) readSlots(entry.right, slots);
+    }
+
+    // Кандидаты — вычисляемые выражения, встреченные хотя бы дважды.
+    void selectCandidates(size_t frameSize) {
+        bitOf.assign(dag.size(), None);
+        killStart.assign(frameSize + 1, 0);
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;  // (ячейка, бит)
+        std::vector<uint32_t> slots;
+        for (uint32_t id = 0; id < counts.size(); ++id) {
+            ValueType type = dag[id].valueType;
+            if (counts[id] < 2 || type == ValueType::Unknown || type == ValueType::String) continue;
+            auto bit = static_cast<uint32_t>(bits++);
+            bitOf[id] = bit;
+            slots.clear();
+            readSlots(id, slots);
+            for (uint32_t slot: slots) pairs.emplace_back(slot, bit);
+        }
+        stats.candidates = bits;
+        for (const auto &pair: pairs) ++killStart[pair.first + 1];
+        for (size_t s = 0; s < frameSize; ++s) killStart[s + 1] += killStart[s];
+        kills.resize(pairs.size());
+        std::vector<uint32_t> fill(killStart.begin(), killStart.end() - 1);
+        for (const auto &pair: pairs) kills[fill[pair.first]++] = pair.second;
+    }
+
+    // Заполняет ли оператор временные: условие while выполняется на
+    // каждой итерации, перед закреплённым объявлением вставлять некуда.
+    bool fillsTemporaries(const ASTNode &statement) const {
+        return statement.type != ASTNodeType::WhileStatement && !pinned.count(&statement);
+    }
+
+    void generate(const ASTNode &node, uint64_t *gen) const {
+        if (!computed(node)) return;
+        uint32_t bit = bitOfNode(node);
+        if (bit != None) gen[bit / 64] |= uint64_t(1) << (bit % 64);
+        for (const auto &child: node.children) generate(*child, gen);
+    }
+
+    DataflowProblem problem() {
+        DataflowProblem result;
+        result.direction = Direction::Forward;
+        result.meet = Meet::Intersection;
+        result.bits = bits;
+        result.gen = BitMatrix(cfg.blocks.size(), bits);
+        result.kill = BitMatrix(cfg.blocks.size(), bits);
+        result.boundary.assign(result.gen.words(), 0);
+        for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+            const BasicBlock &block = cfg.blocks[b];
+            uint64_t *gen = result.gen.row(b);
+            for (uint32_t s = block.firstStatement; s < block.firstStatement + block.statementCount; ++s) {
+                const ASTNode &statement = *cfg.statements[s];
+                if (fillsTemporaries(statement)) {
+                    statementRoots(statement, roots);
+                    for (const NodePtr *root: roots) generate(**root, gen);
+                }
+                for (const Access *access = cfg.accessBegin(s); access != cfg.accessEnd(s); ++access) {
+                    if (!access->write) continue;
+                    for (uint32_t k = killStart[access->slot]; k < killStart[access->slot + 1]; ++k) {
+                        result.gen.reset(b, kills[k]);
+                        result.kill.set(b, kills[k]);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    // Сверху вниз: доступное выражение заменяется целиком, иначе после
+    // детей оно само становится доступным.
+    void visit(const ASTNode &node, uint32_t statement, bool store, std::vector<uint32_t> &mark,
+               uint32_t generation, std::vector<Candidate> &candidates, std::vector<uint8_t> &used) {
+        if (!computed(node)) return;
+        uint32_t id = idOf(node);
+        uint32_t bit = id == None ? None : bitOf[id];
+        if (bit != None && mark[bit] == generation) {
+            uses.emplace(&node, id);
+            touched.insert(cfg.statements[statement]);
+            used[id] = 1;
+            return;
+        }
+        for (const auto &child: node.children) {
+            visit(*child, statement, store, mark, generation, candidates, used);
+        }
+        if (bit != None && store) {
+            mark[bit] = generation;
+            candidates.push_back({&node, id, statement});
+        }
+    }
+
+    void findRedundancies() {
+        // Множество доступных — метки поколения: сброс между блоками не
+        // требует прохода по всем битам.
+        std::vector<uint32_t> mark(bits, 0);
+        uint32_t generation = 0;
+        std::vector<Candidate> candidates;
+        std::vector<uint8_t> used(dag.size(), 0);
+        for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+            ++generation;
+            const BasicBlock &block = cfg.blocks[b];
+            if (stats.global && reachable[b]) {
+                const uint64_t *in = available.in.row(b);
+                for (size_t w = 0; w < available.in.words(); ++w) {
+                    for (uint64_t word = in[w]; word; word &= word - 1) {
+                        mark[w * 64 + __builtin_ctzll(word)] = generation;
+                    }
+                }
+            }
+            for (uint32_t s = block.firstStatement; s < block.firstStatement + block.statementCount; ++s) {
+                const ASTNode &statement = *cfg.statements[s];
+                statementRoots(statement, roots);
+                bool store = fillsTemporaries(statement);
+                for (const NodePtr *root: roots) {
+                    visit(**root, s, store, mark, generation, candidates, used);
+                }
+                for (const Access *access = cfg.accessBegin(s); access != cfg.accessEnd(s); ++access) {
+                    if (!access->write) continue;
+                    for (uint32_t k = killStart[access->slot]; k < killStart[access->slot + 1]; ++k) {
+                        mark[kills[k]] = 0;
+                    }
+                }
+            }
+        }
+
+        // Сохраняют результат все вычисления выражения, которое хоть раз
+        // переиспользовано: до замены могло дойти любое из них.
+        std::vector<uint32_t> temporaryOf(dag.size(), None);
+        auto temporary = [&](uint32_t id) {
+            if (temporaryOf[id] == None) {
+                temporaryOf[id] = static_cast<uint32_t>(temporaries.size());
+                temporaries.push_back({"cse$" + std::to_string(temporaries.size()), dag[id].valueType});
+            }
+            return temporaryOf[id];
+        };
+        for (const Candidate &candidate: candidates) {
+            if (!used[candidate.id]) continue;
+            stores.emplace(candidate.node, temporary(candidate.id));
+            prefixes[cfg.statements[candidate.statement]].push_back(candidate.node);
+            touched.insert(cfg.statements[candidate.statement]);
+        }
+        for (auto &use: uses) use.second = temporary(use.second);
+        stats.reused = uses.size();
+        stats.temporaries = temporaries.size();
+    }
+};
+
+class CseRewriter : public AstRewriter<CseRewriter> {
+public:
+    explicit CseRewriter(const CseAnalysis &analysis) : analysis(analysis) {}
+
+    // В операторы без замен не спускаемся.
+    bool enterAssignment(ASTNode &node) { return analysis.touched.count(&node) != 0; }
+    bool enterVarDecl(ASTNode &node) { return analysis.touched.count(&node) != 0; }
+    bool enterProcedureCall(ASTNode &node) { return analysis.touched.count(&node) != 0; }
+
+    bool enterExpression(ASTNode &node) { return !analysis.uses.count(&node); }
+    bool enterTerm(ASTNode &node) { return !analysis.uses.count(&node); }
+    bool enterFactor(ASTNode &node) { return !analysis.uses.count(&node); }
+
+    NodePtr rewriteExpression(const NodePtr &node) { return replace(node); }
+    NodePtr rewriteTerm(const NodePtr &node) { return replace(node); }
+    NodePtr rewriteFactor(const NodePtr &node) { return replace(node); }
+
+    NodePtr rewriteStatementBlock(const NodePtr &node) {
+        std::vector<NodePtr> children;
+        children.reserve(node->children.size());
+        for (const auto &child: node->children) {
+            prefix(*child, children);
+            children.push_back(child);
+        }
+        node->children = std::move(children);
+        return node;
+    }
+
+    NodePtr rewriteIfStatement(const NodePtr &node) { return wrapBranches(node); }
+    NodePtr rewriteWhileStatement(const NodePtr &node) { return wrapBranches(node); }
+
+    NodePtr rewriteBlock(const NodePtr &node) {
+        // Временные — переменные программы: их видно из любой области.
+        const auto &temporaries = analysis.temporaries;
+        for (ValueType type: {ValueType::Boolean, ValueType::Integer, ValueType::Real}) {
+            std::string names;
+            for (const auto &temporary: temporaries) {
+                if (temporary.type != type) continue;
+                if (!names.empty()) names += ", ";
+                names += temporary.name;
+            }
+            if (names.empty()) continue;
+            auto decl = std::make_shared<ASTNode>(ASTNodeType::VarDecl, names + " : " + valueTypeName(type));
+            node->children.insert(node->children.end() - 1, decl);
+        }
+        return node;
+    }
+
+private:
+    const CseAnalysis &analysis;
+    std::unordered_map<const ASTNode *, NodePtr> saved;     // сохраняемые вычисления после переписывания
+
+    NodePtr read(uint32_t temporary) const {
+        const auto &info = analysis.temporaries[temporary];
+        auto node = std::make_shared<ASTNode>(ASTNodeType::Factor, info.name);
+        node->factor = FactorKind::Name;
+        node->valueType = info.type;
+        return node;
+    }
+
+    NodePtr replace(const NodePtr &node) {
+        auto use = analysis.uses.find(node.get());
+        if (use != analysis.uses.end()) return read(use->second);
+        auto store = analysis.stores.find(node.get());
+        if (store == analysis.stores.end()) return node;
+        saved.emplace(node.get(), node);
+        return read(store->second);
+    }
+
+    void prefix(const ASTNode &statement, std::vector<NodePtr> &out) {
+        auto found = analysis.prefixes.find(&statement);
+        if (found == analysis.prefixes.end()) return;
+        for (const ASTNode *computation: found->second) {
+            auto assignment = std::make_shared<ASTNode>(ASTNodeType::Assignment,
+                                                        analysis.temporaries[analysis.stores.at(computation)].name);
+            assignment->addChild(saved.at(computation));
+            out.push_back(assignment);
+        }
+    }
+
+    NodePtr wrapBranches(const NodePtr &node) {
+        for (size_t i = 1; i < node->children.size(); ++i) {
+            NodePtr &branch = node->children[i];
+            if (branch->type == ASTNodeType::StatementBlock || !analysis.prefixes.count(branch.get())) continue;
+            auto block = std::make_shared<ASTNode>(ASTNodeType::StatementBlock);
+            prefix(*branch, block->children);
+            block->addChild(branch);
+            branch = block;
+        }
+        return node;
+    }
+};
+
+}
+
+CseStats eliminateCommonSubexpressions(std::shared_ptr<ASTNode> &root) {
+    CseStats stats;
+    Resolution resolution = resolveNames(*root);
+    checkTypes(*root, resolution);
+    CseAnalysis analysis(*root, resolution, stats);
+    if (analysis.temporaries.empty()) return stats;
+    CseRewriter rewriter(analysis);
+    root = rewriter.rewrite(root);
+    return stats;
+}
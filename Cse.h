@@ -0,0 +1,27 @@
+#ifndef CSE_H
+#define CSE_H
+
+#include "AST.h"
+#include <cstddef>
+#include <memory>
+
+struct CseStats {
+    size_t candidates = 0;      // различных выражений, встреченных хотя бы дважды
+    size_t reused = 0;          // вычислений заменено чтением временной
+    size_t temporaries = 0;
+    bool global = true;         // false — программа велика, повторы ищутся только внутри базовых блоков
+};
+
+// Удаление общих подвыражений. Выражения нумеруются хэш-консингом
+// (ExprDag): одинаковый номер — одинаковая структура над теми же ячейками.
+// Доступные выражения — прямая задача потока данных с пересечением по графу
+// потока управления: оператор делает доступными свои подвыражения, а запись
+// в ячейку убивает все выражения, которые её читают. Вычисление, доступное
+// на входе, заменяется чтением глобальной временной cse$N, а каждое
+// вычисление, от которого оно могло дойти, сохраняет результат в неё:
+//   y := (a + b) * 2; z := a + b   ->   cse$0 := a + b; y := cse$0 * 2; z := cse$0
+// Выражения условия while временную не заполняют: заголовок выполняется
+// многократно, а присваивание перед циклом — один раз.
+CseStats eliminateCommonSubexpressions(std::shared_ptr<ASTNode> &root);
+
+#endif
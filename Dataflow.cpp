@@ -0,0 +1,356 @@
+#include "Dataflow.h"
+#include <algorithm>
+
+namespace {
+
+// Маска значимых битов последнего слова строки.
+uint64_t lastWordMask(size_t bits) {
+    return bits % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (bits % 64)) - 1;
+}
+
+void fillOnes(uint64_t *row, size_t words, size_t bits) {
+    std::fill(row, row + words, ~uint64_t(0));
+    if (words > 0) row[words - 1] &= lastWordMask(bits);
+}
+
+std::string accessName(const Access &access) {
+    const ASTNode &node = *access.node;
+    if (node.type == ASTNodeType::VarDecl) {
+        auto names = declaredNames(node);
+        size_t i = access.slot - static_cast<uint32_t>(node.slot);
+        return i < names.size() ? names[i] : node.value;
+    }
+    if (node.type == ASTNodeType::ConstDecl) return declaredNames(node).front();
+    return node.value;
+}
+
+}
+
+DataflowResult solveDataflow(const Cfg &cfg, const DataflowProblem &problem) {
+    size_t blocks = cfg.blocks.size();
+    bool forward = problem.direction == Direction::Forward;
+    bool intersect = problem.meet == Meet::Intersection;
+    uint32_t boundaryBlock = forward ? cfg.entry : cfg.exit;
+
+    DataflowResult result{BitMatrix(blocks, problem.bits), BitMatrix(blocks, problem.bits)};
+    size_t words = result.in.words();
+    if (intersect) {
+        // Для пересечения начальное приближение — «всё», иначе цикл
+        // навсегда останется с пустым множеством.
+        for (size_t b = 0; b < blocks; ++b) {
+            fillOnes(result.in.row(b), words, problem.bits);
+            fillOnes(result.out.row(b), words, problem.bits);
+        }
+    }
+
+    std::vector<uint32_t> order = reversePostorder(cfg);
+    if (!forward) std::reverse(order.begin(), order.end());
+
+    // Кольцевая очередь: каждый блок в ней не более одного раза.
+    std::vector<uint32_t> queue(blocks + 1);
+    std::vector<uint8_t> queued(blocks, 0);
+    size_t head = 0, tail = 0;
+    auto push = [&](uint32_t block) {
+        if (queued[block]) return;
+        queued[block] = 1;
+        queue[tail] = block;
+        tail = tail + 1 == queue.size() ? 0 : tail + 1;
+    };
+    for (uint32_t block: order) push(block);
+
+    while (head != tail) {
+        uint32_t b = queue[head];
+        head = head + 1 == queue.size() ? 0 : head + 1;
+        queued[b] = 0;
+        ++result.visits;
+        const BasicBlock &block = cfg.blocks[b];
+
+        // Слияние значений соседей.
+        uint64_t *input = forward ? result.in.row(b) : result.out.row(b);
+        if (b == boundaryBlock) {
+            std::copy(problem.boundary.begin(), problem.boundary.end(), input);
+        } else {
+            const BitMatrix &neighbourRows = forward ? result.out : result.in;
+            bool first = true;
+            auto meet = [&](uint32_t neighbour) {
+                const uint64_t *row = neighbourRows.row(neighbour);
+                if (first) {
+                    std::copy(row, row + words, input);
+                    first = false;
+                } else if (intersect) {
+                    for (size_t w = 0; w < words; ++w) input[w] &= row[w];
+                } else {
+                    for (size_t w = 0; w < words; ++w) input[w] |= row[w];
+                }
+            };
+            if (forward) {
+                for (const uint32_t *p = cfg.predecessorBegin(block); p != cfg.predecessorEnd(block); ++p) meet(*p);
+            } else {
+                for (int32_t successor: block.successors) {
+                    if (successor >= 0) meet(static_cast<uint32_t>(successor));
+                }
+            }
+            if (first && !intersect) std::fill(input, input + words, 0);
+        }
+
+        // Передаточная функция.
+        const uint64_t *gen = problem.gen.row(b);
+        const uint64_t *kill = problem.kill.row(b);
+        uint64_t *output = forward ? result.out.row(b) : result.in.row(b);
+        bool changed = false;
+        for (size_t w = 0; w < words; ++w) {
+            uint64_t value = gen[w] | (input[w] & ~kill[w]);
+            changed |= value != output[w];
+            output[w] = value;
+        }
+        if (!changed) continue;
+
+        if (forward) {
+            for (int32_t successor: block.successors) {
+                if (successor >= 0) push(static_cast<uint32_t>(successor));
+            }
+        } else {
+            for (const uint32_t *p = cfg.predecessorBegin(block); p != cfg.predecessorEnd(block); ++p) push(*p);
+        }
+    }
+    return result;
+}
+
+DataflowResult liveVariables(const Cfg &cfg) {
+    DataflowProblem problem;
+    problem.direction = Direction::Backward;
+    problem.meet = Meet::Union;
+    problem.bits = cfg.variables;
+    problem.gen = BitMatrix(cfg.blocks.size(), cfg.variables);
+    problem.kill = BitMatrix(cfg.blocks.size(), cfg.variables);
+    problem.boundary.assign(problem.gen.words(), 0);
+
+    for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        const BasicBlock &block = cfg.blocks[b];
+        // Снизу вверх: использование выше записи делает переменную живой на входе.
+        for (uint32_t s = block.firstStatement + block.statementCount; s-- > block.firstStatement;) {
+            for (const Access *a = cfg.accessEnd(s); a-- != cfg.accessBegin(s);) {
+                if (a->write) {
+                    problem.gen.reset(b, a->slot);
+                    problem.kill.set(b, a->slot);
+                } else {
+                    problem.gen.set(b, a->slot);
+                }
+            }
+        }
+    }
+    return solveDataflow(cfg, problem);
+}
+
+MergePoints placeMerges(const Cfg &cfg, const Dominators &dominators, const DataflowResult *live) {
+    size_t blocks = cfg.blocks.size();
+
+    // Блоки с записями каждой ячейки.
+    std::vector<uint32_t> defStart(cfg.variables + 1, 0), defBlocks;
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        std::vector<uint32_t> seen(cfg.variables, UINT32_MAX);
+        for (uint32_t b = 0; b < blocks; ++b) {
+            const BasicBlock &block = cfg.blocks[b];
+            for (uint32_t s = block.firstStatement; s < block.firstStatement + block.statementCount; ++s) {
+                for (const Access *a = cfg.accessBegin(s); a != cfg.accessEnd(s); ++a) {
+                    if (!a->write || seen[a->slot] == b) continue;
+                    seen[a->slot] = b;
+                    pairs.emplace_back(a->slot, b);
+                }
+            }
+        }
+        for (const auto &pair: pairs) ++defStart[pair.first + 1];
+        for (size_t v = 0; v < cfg.variables; ++v) defStart[v + 1] += defStart[v];
+        defBlocks.resize(pairs.size());
+        std::vector<uint32_t> fill(defStart.begin(), defStart.end() - 1);
+        for (const auto &pair: pairs) defBlocks[fill[pair.first]++] = pair.second;
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> merges;     // (блок, ячейка)
+    std::vector<uint32_t> placed(blocks, UINT32_MAX), queued(blocks, UINT32_MAX), work;
+    for (uint32_t v = 0; v < cfg.variables; ++v) {
+        work.assign(defBlocks.begin() + defStart[v], defBlocks.begin() + defStart[v + 1]);
+        for (uint32_t b: work) queued[b] = v;
+        while (!work.empty()) {
+            uint32_t b = work.back();
+            work.pop_back();
+            for (const uint32_t *f = dominators.frontierBegin(b); f != dominators.frontierEnd(b); ++f) {
+                if (placed[*f] == v) continue;
+                placed[*f] = v;
+                if (!live || live->in.test(*f, v)) merges.emplace_back(*f, v);
+                if (queued[*f] != v) {
+                    queued[*f] = v;
+                    work.push_back(*f);
+                }
+            }
+        }
+    }
+
+    MergePoints result;
+    result.start.assign(blocks + 1, 0);
+    for (const auto &merge: merges) ++result.start[merge.first + 1];
+    for (size_t b = 0; b < blocks; ++b) result.start[b + 1] += result.start[b];
+    result.slots.resize(merges.size());
+    std::vector<uint32_t> fill(result.start.begin(), result.start.end() - 1);
+    for (const auto &merge: merges) result.slots[fill[merge.first]++] = merge.second;
+    return result;
+}
+
+ReachingDefinitions reachingDefinitions(const Cfg &cfg, const Dominators &dominators, const DataflowResult &live) {
+    ReachingDefinitions result;
+    auto accessCount = static_cast<uint32_t>(cfg.accesses.size());
+
+    // Слияния по блокам, операнды подряд.
+    MergePoints points = placeMerges(cfg, dominators, &live);
+    const auto &mergeStart = points.start;
+    uint32_t operandCount = 0;
+    result.merges.reserve(points.slots.size());
+    for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        for (uint32_t m = mergeStart[b]; m < mergeStart[b + 1]; ++m) {
+            result.merges.push_back({b, points.slots[m], operandCount});
+            operandCount += cfg.blocks[b].predecessorCount;
+        }
+    }
+    result.operands.assign(operandCount, ReachingDefinitions::Initial);
+
+    // Переименование: обход дерева доминаторов со стеком текущих значений
+    // каждой ячейки; журнал отката восстанавливает стеки при подъёме.
+    result.reaching.assign(accessCount, ReachingDefinitions::Initial);
+    std::vector<uint32_t> current(cfg.variables, ReachingDefinitions::Initial);
+    std::vector<std::pair<uint32_t, uint32_t>> undo;       // (ячейка, прежнее значение)
+    std::vector<std::pair<uint32_t, size_t>> path;         // (блок, размер журнала при входе)
+    auto define = [&](uint32_t slot, uint32_t value) {
+        undo.emplace_back(slot, current[slot]);
+        current[slot] = value;
+    };
+    const auto &idom = dominators.idom;
+    for (uint32_t b: dominators.preorder) {
+        while (!path.empty() && path.back().first != idom[b]) {
+            for (size_t mark = path.back().second; undo.size() > mark; undo.pop_back()) {
+                current[undo.back().first] = undo.back().second;
+            }
+            path.pop_back();
+        }
+        path.emplace_back(b, undo.size());
+
+        for (uint32_t m = mergeStart[b]; m < mergeStart[b + 1]; ++m) {
+            define(result.merges[m].slot, accessCount + m);
+        }
+        const BasicBlock &block = cfg.blocks[b];
+        for (uint32_t s = block.firstStatement; s < block.firstStatement + block.statementCount; ++s) {
+            for (const Access *a = cfg.accessBegin(s); a != cfg.accessEnd(s); ++a) {
+                auto index = static_cast<uint32_t>(a - cfg.accesses.data());
+                if (a->write) {
+                    define(a->slot, index);
+                } else {
+                    result.reaching[index] = current[a->slot];
+                }
+            }
+        }
+        for (int32_t successor: block.successors) {
+            if (successor < 0) continue;
+            const BasicBlock &target = cfg.blocks[successor];
+            uint32_t position = 0;
+            while (cfg.predecessors[target.firstPredecessor + position] != b) ++position;
+            for (uint32_t m = mergeStart[successor]; m < mergeStart[successor + 1]; ++m) {
+                const auto &merge = result.merges[m];
+                result.operands[merge.firstOperand + position] = current[merge.slot];
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<const Access *> ReachingDefinitions::definitions(const Cfg &cfg, size_t access, bool *initial) const {
+    std::vector<const Access *> found;
+    if (initial) *initial = false;
+    auto accessCount = static_cast<uint32_t>(cfg.accesses.size());
+    std::vector<uint8_t> seen(merges.size(), 0);
+    std::vector<uint32_t> stack{reaching[access]};
+    while (!stack.empty()) {
+        uint32_t value = stack.back();
+        stack.pop_back();
+        if (value == Initial) {
+            if (initial) *initial = true;
+        } else if (value < accessCount) {
+            found.push_back(&cfg.accesses[value]);
+        } else if (!seen[value - accessCount]) {
+            const Merge &merge = merges[value - accessCount];
+            seen[value - accessCount] = 1;
+            uint32_t count = cfg.blocks[merge.block].predecessorCount;
+            stack.insert(stack.end(), operands.begin() + merge.firstOperand,
+                         operands.begin() + merge.firstOperand + count);
+        }
+    }
+    // Одна запись может прийти по нескольким путям.
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    return found;
+}
+
+DataflowResult definitelyAssigned(const Cfg &cfg) {
+    DataflowProblem problem;
+    problem.direction = Direction::Forward;
+    problem.meet = Meet::Intersection;
+    problem.bits = cfg.variables;
+    problem.gen = BitMatrix(cfg.blocks.size(), cfg.variables);
+    problem.kill = BitMatrix(cfg.blocks.size(), cfg.variables);
+    problem.boundary.assign(problem.gen.words(), 0);
+    for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+        const BasicBlock &block = cfg.blocks[b];
+        for (uint32_t s = block.firstStatement; s < block.firstStatement + block.statementCount; ++s) {
+            for (const Access *a = cfg.accessBegin(s); a != cfg.accessEnd(s); ++a) {
+                if (a->write) problem.gen.set(b, a->slot);
+            }
+        }
+    }
+    return solveDataflow(cfg, problem);
+}
+
+std::vector<std::string> dataflowWarnings(const Cfg &cfg, const DataflowResult &live,
+                                          const DataflowResult &assigned) {
+    std::vector<std::string> warnings;
+    std::vector<uint8_t> reported(cfg.variables, 0);
+    std::vector<uint64_t> state(live.in.words());
+    std::vector<uint32_t> reachable = reversePostorder(cfg);
+    std::sort(reachable.begin(), reachable.end());
+
+    for (uint32_t b: reachable) {
+        const BasicBlock &block = cfg.blocks[b];
+        uint32_t first = block.firstStatement, end = first + block.statementCount;
+
+        const uint64_t *in = assigned.in.row(b);
+        state.assign(in, in + state.size());
+        for (uint32_t s = first; s < end; ++s) {
+            for (const Access *a = cfg.accessBegin(s); a != cfg.accessEnd(s); ++a) {
+                uint64_t bit = uint64_t(1) << (a->slot % 64);
+                if (a->write) {
+                    state[a->slot / 64] |= bit;
+                } else if (!(state[a->slot / 64] & bit) && !reported[a->slot]) {
+                    reported[a->slot] = 1;
+                    warnings.push_back("Переменная " + a->node->value + " может читаться до присваивания");
+                }
+            }
+        }
+
+        const uint64_t *out = live.out.row(b);
+        state.assign(out, out + state.size());
+        for (uint32_t s = end; s-- > first;) {
+            for (const Access *a = cfg.accessEnd(s); a-- != cfg.accessBegin(s);) {
+                uint64_t bit = uint64_t(1) << (a->slot % 64);
+                if (!a->write) {
+                    state[a->slot / 64] |= bit;
+                    continue;
+                }
+                ASTNodeType type = a->node->type;
+                if (!(state[a->slot / 64] & bit) &&
+                    (type == ASTNodeType::Assignment || type == ASTNodeType::VarDecl)) {
+                    warnings.push_back("Значение, присвоенное " + accessName(*a) + ", не используется");
+                }
+                state[a->slot / 64] &= ~bit;
+            }
+        }
+    }
+    return warnings;
+}
@@ -0,0 +1,111 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include "Cfg.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Плотная матрица битов: строка на блок, строки подряд в одном массиве.
+class BitMatrix {
+public:
+    BitMatrix() = default;
+    BitMatrix(size_t rows, size_t bits)
+            : wordsPerRow((bits + 63) / 64), data(rows * wordsPerRow, 0) {}
+
+    size_t words() const { return wordsPerRow; }
+
+    uint64_t *row(size_t r) { return data.data() + r * wordsPerRow; }
+    const uint64_t *row(size_t r) const { return data.data() + r * wordsPerRow; }
+
+    bool test(size_t r, size_t bit) const { return row(r)[bit / 64] >> (bit % 64) & 1; }
+    void set(size_t r, size_t bit) { row(r)[bit / 64] |= uint64_t(1) << (bit % 64); }
+    void reset(size_t r, size_t bit) { row(r)[bit / 64] &= ~(uint64_t(1) << (bit % 64)); }
+
+private:
+    size_t wordsPerRow = 0;
+    std::vector<uint64_t> data;
+};
+
+enum class Direction { Forward, Backward };
+enum class Meet { Union, Intersection };
+
+// Задача с передаточной функцией out = gen | (in & ~kill) для каждого блока.
+// boundary — значение на входе начального блока (прямая задача) или на
+// выходе конечного (обратная).
+struct DataflowProblem {
+    Direction direction = Direction::Forward;
+    Meet meet = Meet::Union;
+    size_t bits = 0;
+    BitMatrix gen;
+    BitMatrix kill;
+    std::vector<uint64_t> boundary;
+};
+
+struct DataflowResult {
+    BitMatrix in;           // на входе блока
+    BitMatrix out;          // на выходе блока
+    size_t visits = 0;      // обработано блоков из очереди
+};
+
+// Итеративное решение по очереди блоков в обратном постпорядке (для
+// обратных задач — в постпорядке): блок возвращается в очередь, только если
+// изменилось значение на границе у его соседа.
+DataflowResult solveDataflow(const Cfg &cfg, const DataflowProblem &problem);
+
+// Живые переменные (обратная задача, объединение): бит — ячейка кадра.
+DataflowResult liveVariables(const Cfg &cfg);
+
+// Точки слияния значений ячеек: итерированная граница доминирования блоков
+// с записями ячейки. С live слияние ставится, только если ячейка жива на
+// входе блока (усечённая форма), без него — везде, и тогда в любой точке
+// программы известно текущее значение каждой ячейки.
+struct MergePoints {
+    std::vector<uint32_t> start;            // ячейки, сливаемые на входе блока b: [start[b], start[b + 1])
+    std::vector<uint32_t> slots;
+};
+
+MergePoints placeMerges(const Cfg &cfg, const Dominators &dominators, const DataflowResult *live);
+
+// Достигающие определения в разреженном виде. Плотные битовые строки
+// «блоки x все определения программы» на 100 тысячах операторов занимают
+// гигабайты, поэтому определения не размножаются по блокам: каждому чтению
+// сопоставляется одно значение — запись, слияние в начале блока (на границе
+// доминирования записей, только там, где ячейка жива) или начальное значение
+// кадра. Множество записей, доходящих до чтения, раскрывается через слияния.
+struct ReachingDefinitions {
+    static constexpr uint32_t Initial = UINT32_MAX;
+
+    // Слияние значений ячейки slot на входе block; операнды — по одному на
+    // предшественника, в порядке cfg.predecessors.
+    struct Merge {
+        uint32_t block;
+        uint32_t slot;
+        uint32_t firstOperand;
+    };
+
+    // Значение: номер записи в cfg.accesses, cfg.accesses.size() + номер
+    // слияния или Initial. reaching[i] — значение для чтения cfg.accesses[i]
+    // (для записей — Initial).
+    std::vector<uint32_t> reaching;
+    std::vector<Merge> merges;
+    std::vector<uint32_t> operands;
+
+    // Записи, которые могут дойти до чтения access; initial — может ли
+    // дойти начальное значение кадра.
+    std::vector<const Access *> definitions(const Cfg &cfg, size_t access, bool *initial = nullptr) const;
+};
+
+ReachingDefinitions reachingDefinitions(const Cfg &cfg, const Dominators &dominators, const DataflowResult &live);
+
+// Определённо присвоенные переменные (прямая задача, пересечение).
+DataflowResult definitelyAssigned(const Cfg &cfg);
+
+// Предупреждения по результатам анализов: чтение переменной, которой на
+// каком-то пути ещё не присваивали, и присваивание, значение которого
+// никогда не читается.
+std::vector<std::string> dataflowWarnings(const Cfg &cfg, const DataflowResult &live,
+                                          const DataflowResult &assigned);
+
+#endif
@@ -0,0 +1,81 @@
+#include "Driver.h"
+#include "Parser.h"
+#include "Trace.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+Driver::Driver(const DriverOptions& options) : options(options) {
+    if (!options.cacheDir.empty()) {
+        cache = std::make_unique<ParseCache>(options.cacheDir, options.cacheLimitBytes);
+    }
+}
+
+Driver::~Driver() {
+    if (cache) {
+        cache->evict();
+    }
+}
+
+std::string Driver::readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Не удалось открыть файл: " + path);
+    }
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+ParseResult Driver::parseSource(const std::string& source) {
+    STATS(++statistics.files;)
+    ParseResult result;
+    uint64_t key = 0;
+    if (cache) {
+        PhaseTimer timer(statistics, StatsPhase::Cache);
+        TraceSpan span("cache.load", "cache");
+        key = ParseCache::makeKey(source, options.grammarFlags);
+        if (cache->load(key, source, result.tokens, result.ast)) {
+            STATS(++statistics.cacheHits;)
+            traceInstant("cache.hit", "cache");
+            result.fromCache = true;
+            return result;
+        }
+    }
+
+    Lexer lexer(source);
+    {
+        PhaseTimer timer(statistics, StatsPhase::Lex);
+        TraceSpan span("lex", "frontend");
+        result.tokens = lexer.tokenize();
+    }
+    STATS(statistics.add(lexer.stats());)
+    Parser parser(result.tokens);
+    try {
+        PhaseTimer timer(statistics, StatsPhase::Parse);
+        TraceSpan span("parse", "frontend");
+        result.ast = parser.parse();
+    } catch (...) {
+        STATS(statistics.add(parser.stats());)
+        throw;
+    }
+    STATS(statistics.add(parser.stats());)
+
+    if (cache) {
+        PhaseTimer timer(statistics, StatsPhase::Cache);
+        TraceSpan span("cache.store", "cache");
+        cache->store(key, source, result.tokens, result.ast);
+    }
+    return result;
+}
+
+ParseResult Driver::parseFile(const std::string& path) {
+    TraceSpan span("file", "driver", path);
+    std::string source;
+    {
+        PhaseTimer timer(statistics, StatsPhase::Read);
+        TraceSpan read("read", "io");
+        source = readFile(path);
+    }
+    return parseSource(source);
+}
@@ -0,0 +1,48 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include "AST.h"
+#include "Lexer.h"
+#include "ParseCache.h"
+#include "Stats.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct DriverOptions {
+    std::string cacheDir;                      // пустая строка — кэш отключён
+    uint64_t cacheLimitBytes = 256ull << 20;
+    uint32_t grammarFlags = 0;                 // входят в ключ кэша
+};
+
+struct ParseResult {
+    std::vector<Token> tokens;
+    std::shared_ptr<ASTNode> ast;
+    bool fromCache = false;
+};
+
+// Конвейер чтение -> лексер -> парсер с необязательным кэшем на диске.
+class Driver {
+public:
+    Driver(const DriverOptions& options = DriverOptions());
+    ~Driver();
+
+    ParseResult parseSource(const std::string& source);
+    ParseResult parseFile(const std::string& path);
+
+    static std::string readFile(const std::string& path);
+
+    const ParseCache* parseCache() const { return cache.get(); }
+
+    // Счётчики по всем разобранным файлам; фазы после разбора (анализ,
+    // вывод) дописывает вызывающий код.
+    PipelineStats& stats() { return statistics; }
+
+private:
+    DriverOptions options;
+    std::unique_ptr<ParseCache> cache;
+    PipelineStats statistics;
+};
+
+#endif
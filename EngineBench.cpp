@@ -0,0 +1,334 @@
+#include "Cse.h"
+#include "Driver.h"
+#include "ExprDag.h"
+#include "Interpreter.h"
+#include "Jit.h"
+#include "Licm.h"
+#include "Ssa.h"
+#include "Tiered.h"
+#include "OutputBuffer.h"
+#include "VM.h"
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <cstdio>
+#ifdef _WIN32
+#include <io.h>
+#endif
+#include <functional>
+#include <memory>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Сравнение исполнителей на числовых циклах: обход AST против байткода.
+// engine_bench [--pairs | --ssa | --licm | --cse] [число повторов]
+// --pairs печатает самые частые пары подряд выполненных команд VM (без
+// суперинструкций) и число диспетчеризаций до и после слияния.
+// --ssa сравнивает число выполненных команд VM до и после optimizeSsa.
+// --licm сравнивает время итерации цикла с инвариантами до и после выноса.
+// --cse — то же для цикла с общими подвыражениями до и после их удаления.
+
+namespace {
+
+// Алгоритм бисекции из README, повторённый n раз.
+const char *BISECTION = R"(
+const eps = 0.000000001;
+var a, b, fa, k, n: real;
+begin
+  readln(n);
+  k := 0;
+  while k < n do
+  begin
+    a := 2;
+    b := 4;
+    fa := sin(a);
+    while (b-a) > eps do
+    begin
+      var x := (b+a)/2;
+      var fx := sin(x);
+      if fa*fx <= 0 then
+        b := x;
+      else
+      begin
+        a := x;
+        fa := fx;
+      end;
+    end;
+    k := k + 1;
+  end;
+  writeln('root = ', (b+a)/2);
+end.
+)";
+
+// Та же бисекция в стиле скриптов: лишние копии и никем не читаемые
+// переприсваивания (fb нигде не используется).
+const char *BISECTION_COPIES = R"(
+const eps = 0.000000001;
+var a, b, fa, fb, k, n: real;
+begin
+  readln(n);
+  k := 0;
+  while k < n do
+  begin
+    a := 2;
+    b := 4;
+    fa := sin(a);
+    fb := sin(b);
+    while (b-a) > eps do
+    begin
+      var x := (b+a)/2;
+      var fx := sin(x);
+      var left := fa;
+      if left*fx <= 0 then
+      begin
+        b := x;
+        fb := fx;
+      end
+      else
+      begin
+        a := x;
+        fa := fx;
+      end;
+    end;
+    k := k + 1;
+  end;
+  writeln('root = ', (b+a)/2);
+end.
+)";
+
+const char *ARITHMETIC = R"(
+var i, s, n: real;
+begin
+  readln(n);
+  i := 0;
+  s := 0;
+  while i < n do
+  begin
+    var x := i / n;
+    if x*x <= 0.25 then
+      s := s + x * 2 - 1;
+    else
+      s := s - x / 3 + 0.5;
+    i := i + 1;
+  end;
+  writeln('s = ', s);
+end.
+)";
+
+// Цикл, пересчитывающий на каждой итерации то, что от неё не зависит.
+const char *INVARIANT = R"(
+const scale = 0.5;
+var i, n, s, c: real;
+begin
+  readln(n);
+  c := 3;
+  i := 0;
+  s := 0;
+  while i < n do
+  begin
+    s := s + sin(c) * scale * 2 + cos(c * scale) * i;
+    i := i + 1;
+  end;
+  writeln('s = ', s);
+end.
+)";
+
+// Цикл, вычисляющий одно и то же зависящее от итерации выражение трижды.
+const char *REDUNDANT = R"(
+var i, n, s, t, x: real;
+begin
+  readln(n);
+  i := 0;
+  s := 0;
+  t := 0;
+  while i < n do
+  begin
+    x := i * 0.001;
+    s := s + sin(x * x + 1) / (x * x + 1);
+    t := t + sin(x * x + 1) * (x * x + 1);
+    i := i + 1;
+  end;
+  writeln('s = ', s, ' t = ', t);
+end.
+)";
+
+struct Workload {
+    const char *name;
+    const char *source;
+    const char *input;
+};
+
+using Engine = std::function<void(ASTNode &, std::istream &, OutputBuffer &)>;
+using Transform = std::function<void(std::shared_ptr<ASTNode> &)>;
+
+// transform (если задан) применяется к дереву до замера.
+double medianMs(const Workload &workload, const Engine &engine, int repetitions, OutputBuffer &out,
+                const Transform &transform = nullptr) {
+    std::vector<double> samples;
+    Driver driver;
+    for (int i = 0; i < repetitions; ++i) {
+        ParseResult parsed = driver.parseSource(workload.source);
+        if (transform) transform(parsed.ast);
+        std::istringstream in(workload.input);
+        auto start = std::chrono::steady_clock::now();
+        engine(*parsed.ast, in, out);
+        auto finish = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(finish - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// Выполняет нагрузку в VM с профилированием; возвращает число команд.
+uint64_t profile(const Workload &workload, VM &vm, bool ssa = false) {
+    ParseResult parsed = Driver().parseSource(workload.source);
+    if (ssa) optimizeSsa(parsed.ast);
+    vm.setProfiling(true);
+    vm.run(*parsed.ast);
+    return vm.executedInstructions();
+}
+
+void printPairs(const Workload &workload, OutputBuffer &out) {
+    std::istringstream fusedIn(workload.input), plainIn(workload.input);
+    VM fusedVm(fusedIn, out), plainVm(plainIn, out);
+    plainVm.setSuperinstructions(false);
+    uint64_t fused = profile(workload, fusedVm);
+    uint64_t plain = profile(workload, plainVm);
+
+    struct Pair {
+        uint64_t count;
+        OpCode first, second;
+    };
+    std::vector<Pair> pairs;
+    for (size_t i = 0; i < VM::OPCODE_COUNT; ++i) {
+        for (size_t j = 0; j < VM::OPCODE_COUNT; ++j) {
+            auto first = static_cast<OpCode>(i), second = static_cast<OpCode>(j);
+            if (uint64_t count = plainVm.pairCount(first, second)) pairs.push_back({count, first, second});
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const Pair &a, const Pair &b) { return a.count > b.count; });
+
+    std::printf("%s: команд без суперинструкций %llu, с ними %llu (x%.2f)\n", workload.name,
+                static_cast<unsigned long long>(plain), static_cast<unsigned long long>(fused),
+                static_cast<double>(plain) / static_cast<double>(fused));
+    for (size_t i = 0; i < pairs.size() && i < 12; ++i) {
+        std::printf("  %5.1f%%  %s %s\n", 100.0 * static_cast<double>(pairs[i].count) / static_cast<double>(plain),
+                    opCodeName(pairs[i].first), opCodeName(pairs[i].second));
+    }
+}
+
+
+void printSsaTrace(const Workload &workload, OutputBuffer &out) {
+    std::istringstream plainIn(workload.input), optimizedIn(workload.input);
+    VM plainVm(plainIn, out), optimizedVm(optimizedIn, out);
+    uint64_t plain = profile(workload, plainVm);
+    uint64_t optimized = profile(workload, optimizedVm, true);
+    std::printf("%s: команд без SSA %llu, после SSA %llu (-%.1f%%)\n", workload.name,
+                static_cast<unsigned long long>(plain), static_cast<unsigned long long>(optimized),
+                100.0 * (1.0 - static_cast<double>(optimized) / static_cast<double>(plain)));
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    bool pairs = mode == "--pairs", ssa = mode == "--ssa", licm = mode == "--licm", cse = mode == "--cse";
+    if (pairs || ssa || licm || cse) {
+        --argc;
+        ++argv;
+    }
+    int repetitions = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5;
+
+    const Workload workloads[] = {
+            {"bisection", BISECTION, "20000"},
+            {"copies", BISECTION_COPIES, "20000"},
+            {"arithmetic", ARITHMETIC, "2000000"},
+    };
+
+    Engine ast = [](ASTNode &program, std::istream &in, OutputBuffer &out) {
+        Interpreter(in, out).run(program);
+    };
+    Engine vm = [](ASTNode &program, std::istream &in, OutputBuffer &out) {
+        VM(in, out).run(program);
+    };
+    Engine jit = [](ASTNode &program, std::istream &in, OutputBuffer &out) {
+        runWithJit(program, in, out);
+    };
+    Engine tiered = [](ASTNode &program, std::istream &in, OutputBuffer &out) {
+        TieredEngine(in, out).run(program);
+    };
+
+    struct NamedEngine {
+        const char *name;
+        Engine *engine;
+    };
+    std::vector<NamedEngine> engines{{"ast", &ast}, {"vm", &vm}};
+    if (jitSupported()) {
+        engines.push_back({"jit", &jit});
+    }
+    engines.push_back({"tiered", &tiered});
+
+    // Вывод самих программ не интересен — отправляем его в /dev/null.
+#ifdef _WIN32
+    int sink = ::_open("NUL", _O_WRONLY);
+#else
+    int sink = ::open("/dev/null", O_WRONLY);
+#endif
+    OutputBuffer out(sink < 0 ? 1 : sink);
+    if (pairs) {
+        for (const auto &workload: workloads) printPairs(workload, out);
+        return 0;
+    }
+    if (ssa) {
+        for (const auto &workload: workloads) printSsaTrace(workload, out);
+        return 0;
+    }
+    if (licm) {
+        const Workload invariant{"invariant", INVARIANT, "2000000"};
+        const double iterations = 2000000.0;
+        Transform hoist = [](std::shared_ptr<ASTNode> &ast) { hoistLoopInvariants(ast); };
+        for (const auto &named: engines) {
+            double plain = medianMs(invariant, *named.engine, repetitions, out);
+            double hoisted = medianMs(invariant, *named.engine, repetitions, out, hoist);
+            std::printf("%-12s %-7s итерация %7.2f нс -> %7.2f нс   x%.2f\n", invariant.name, named.name,
+                        plain * 1e6 / iterations, hoisted * 1e6 / iterations, plain / hoisted);
+        }
+        return 0;
+    }
+    if (cse) {
+        const Workload redundant{"redundant", REDUNDANT, "2000000"};
+        const double iterations = 2000000.0;
+        Transform eliminate = [](std::shared_ptr<ASTNode> &ast) {
+            eliminateCommonSubexpressions(ast);
+            shareExpressions(ast);
+        };
+        ParseResult parsed = Driver().parseSource(redundant.source);
+        CseStats stats = eliminateCommonSubexpressions(parsed.ast);
+        DagStats dag = shareExpressions(parsed.ast);
+        std::printf("%s: заменено вычислений %zu, узлов выражений %zu -> %zu\n", redundant.name,
+                    stats.reused, dag.nodes, dag.unique);
+        for (const auto &named: engines) {
+            double plain = medianMs(redundant, *named.engine, repetitions, out);
+            double optimized = medianMs(redundant, *named.engine, repetitions, out, eliminate);
+            std::printf("%-12s %-7s итерация %7.2f нс -> %7.2f нс   x%.2f\n", redundant.name, named.name,
+                        plain * 1e6 / iterations, optimized * 1e6 / iterations, plain / optimized);
+        }
+        return 0;
+    }
+    std::vector<std::string> report;
+    for (const auto &workload: workloads) {
+        double baseline = 0.0;
+        for (const auto &named: engines) {
+            double ms = medianMs(workload, *named.engine, repetitions, out);
+            if (baseline == 0.0) baseline = ms;
+            char line[160];
+            std::snprintf(line, sizeof line, "%-12s %-7s %9.2f ms   x%.2f\n",
+                          workload.name, named.name, ms, baseline / ms);
+            report.emplace_back(line);
+        }
+    }
+    for (const auto &line: report) std::cout << line;
+    return 0;
+}
@@ -0,0 +1,298 @@
+#ifndef EVENTPARSER_H
+#define EVENTPARSER_H
+
+#include "AST.h"
+#include "Lexer.h"
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Разбор событиями (как SAX) по грамматике Parser, без построения AST.
+// Наследник переопределяет только нужные обработчики (CRTP, как AstVisitor):
+//   void onEnter(ASTNodeType kind);
+//   void onLeave(ASTNodeType kind);
+//   void onToken(const Token &token);   // каждый токен по порядку, внутри
+//                                       // самого глубокого открытого узла
+// Токены берутся из Lexer::next() по одному, в памяти — текущий токен и
+// ещё один для выбора между присваиванием и вызовом, поэтому память не
+// зависит от размера входа (глубина рекурсии — как у Parser).
+//
+// События повторяют узлы Parser с двумя отличиями. Объявление var — всегда
+// один VarDecl: глобальное оно или локальное, видно по ':=' после списка
+// имён, без просмотра вперёд (isLocalVarDecl). Выражение целиком (условие,
+// правая часть, аргумент, выражение в скобках) обёрнуто в Expression, внутри
+// — операнды Factor и операторы токенами в порядке исходного текста: узел
+// бинарной операции Parser пришлось бы открыть до левого операнда, который
+// к моменту появления оператора уже отдан обработчику. Приоритеты
+// операторов на допустимость входа не влияют, так что это та же грамматика.
+// При ошибке бросается std::runtime_error, как у Parser; открытые узлы не
+// закрываются.
+template <typename Derived>
+class EventParser {
+public:
+    void parse(Lexer &lexer) {
+        source = &lexer;
+        buffered = false;
+        token = source->next();
+        parseProgram();
+        source = nullptr;
+    }
+
+    void onEnter(ASTNodeType) {}
+
+    void onLeave(ASTNodeType) {}
+
+    void onToken(const Token &) {}
+
+private:
+    Lexer *source = nullptr;
+    Token token{TokenType::END_OF_FILE, ""};
+    Token following{TokenType::END_OF_FILE, ""};
+    bool buffered = false;
+
+    Derived &derived() { return static_cast<Derived &>(*this); }
+
+    bool at(TokenType type) const { return token.type == type; }
+
+    // Отдаёт текущий токен обработчику и переходит к следующему.
+    void advance() {
+        derived().onToken(token);
+        if (buffered) {
+            token = std::move(following);
+            buffered = false;
+        } else {
+            token = source->next();
+        }
+    }
+
+    const Token &peek() {
+        if (!buffered) {
+            following = source->next();
+            buffered = true;
+        }
+        return following;
+    }
+
+    void expect(TokenType type) {
+        if (!at(type)) {
+            std::ostringstream oss;
+            oss << "Ошибка в строке " << token.line
+                << "\n"
+                << "Найден токен: '" << token.lexeme << "'";
+            throw std::runtime_error(oss.str());
+        }
+        advance();
+    }
+
+    void parseProgram() {
+        derived().onEnter(ASTNodeType::Program);
+        parseBlock();
+        expect(TokenType::DOT);
+        derived().onLeave(ASTNodeType::Program);
+    }
+
+    void parseBlock() {
+        derived().onEnter(ASTNodeType::Block);
+        if (at(TokenType::CONST)) parseConstDecl();
+        if (at(TokenType::VAR)) parseVarDecl();
+        if (at(TokenType::TEMPLATE)) parseTemplateDecl();
+        parseStatementBlock();
+        derived().onLeave(ASTNodeType::Block);
+    }
+
+    void parseConstDecl() {
+        derived().onEnter(ASTNodeType::ConstDecl);
+        expect(TokenType::CONST);
+        do {
+            derived().onEnter(ASTNodeType::ConstDecl);
+            expect(TokenType::IDENT);
+            expect(TokenType::EQ);
+            derived().onEnter(ASTNodeType::Factor);
+            expect(TokenType::NUMBER);
+            derived().onLeave(ASTNodeType::Factor);
+            expect(TokenType::SEMI);
+            derived().onLeave(ASTNodeType::ConstDecl);
+        } while (at(TokenType::IDENT));
+        derived().onLeave(ASTNodeType::ConstDecl);
+    }
+
+    // var a, b [: тип] ; — объявление, var a, b [: тип] := выражение ; — локальная переменная.
+    void parseVarDecl() {
+        derived().onEnter(ASTNodeType::VarDecl);
+        expect(TokenType::VAR);
+        expect(TokenType::IDENT);
+        while (at(TokenType::COMMA)) {
+            advance();
+            expect(TokenType::IDENT);
+        }
+        if (at(TokenType::COLON)) {
+            advance();
+            expect(TokenType::IDENT);
+        }
+        if (at(TokenType::ASSIGN)) {
+            advance();
+            parseExpression();
+        }
+        expect(TokenType::SEMI);
+        derived().onLeave(ASTNodeType::VarDecl);
+    }
+
+    void parseTemplateDecl() {
+        derived().onEnter(ASTNodeType::TemplateDecl);
+        expect(TokenType::TEMPLATE);
+        expect(TokenType::LT);
+        expect(TokenType::TYPENAME);
+        expect(TokenType::IDENT);
+        expect(TokenType::GT);
+        derived().onLeave(ASTNodeType::TemplateDecl);
+    }
+
+    void parseStatementBlock() {
+        derived().onEnter(ASTNodeType::StatementBlock);
+        expect(TokenType::BEGIN);
+        while (!at(TokenType::END)) {
+            parseStatement();
+        }
+        expect(TokenType::END);
+        derived().onLeave(ASTNodeType::StatementBlock);
+    }
+
+    void parseStatement() {
+        switch (token.type) {
+            case TokenType::SEMI:
+                derived().onEnter(ASTNodeType::Unknown);
+                advance();
+                derived().onLeave(ASTNodeType::Unknown);
+                return;
+            case TokenType::BEGIN:
+                parseStatementBlock();
+                return;
+            case TokenType::VAR:
+                parseVarDecl();
+                return;
+            case TokenType::IF:
+                parseIfStatement();
+                return;
+            case TokenType::WHILE:
+                parseWhileStatement();
+                return;
+            case TokenType::WRITE:
+            case TokenType::WRITELN:
+            case TokenType::READLN:
+            case TokenType::ASSERT:
+                parseProcedureCall();
+                return;
+            case TokenType::IDENT:
+                if (peek().type == TokenType::ASSIGN)
+                    parseAssignment();
+                else
+                    parseProcedureCall();
+                return;
+            default:
+                throw std::runtime_error("Неожиданный токен в операторе: " + token.lexeme);
+        }
+    }
+
+    void parseAssignment() {
+        derived().onEnter(ASTNodeType::Assignment);
+        expect(TokenType::IDENT);
+        expect(TokenType::ASSIGN);
+        parseExpression();
+        expect(TokenType::SEMI);
+        derived().onLeave(ASTNodeType::Assignment);
+    }
+
+    void parseIfStatement() {
+        derived().onEnter(ASTNodeType::IfStatement);
+        expect(TokenType::IF);
+        parseExpression();
+        expect(TokenType::THEN);
+        parseStatement();
+        if (at(TokenType::ELSE)) {
+            advance();
+            parseStatement();
+        }
+        derived().onLeave(ASTNodeType::IfStatement);
+    }
+
+    void parseWhileStatement() {
+        derived().onEnter(ASTNodeType::WhileStatement);
+        expect(TokenType::WHILE);
+        parseExpression();
+        expect(TokenType::DO);
+        parseStatement();
+        derived().onLeave(ASTNodeType::WhileStatement);
+    }
+
+    void parseProcedureCall() {
+        derived().onEnter(ASTNodeType::ProcedureCall);
+        advance();
+        expect(TokenType::LPAREN);
+        parseArguments();
+        expect(TokenType::SEMI);
+        derived().onLeave(ASTNodeType::ProcedureCall);
+    }
+
+    // Аргументы до ')' включительно; '(' уже разобрана.
+    void parseArguments() {
+        while (!at(TokenType::RPAREN)) {
+            parseExpression();
+            if (at(TokenType::COMMA))
+                advance();
+            else
+                break;
+        }
+        expect(TokenType::RPAREN);
+    }
+
+    void parseExpression() {
+        derived().onEnter(ASTNodeType::Expression);
+        parseFactor();
+        while (isBinaryOperator(token.type)) {
+            advance();
+            parseFactor();
+        }
+        derived().onLeave(ASTNodeType::Expression);
+    }
+
+    static bool isBinaryOperator(TokenType type) {
+        switch (type) {
+            case TokenType::LT: case TokenType::GT: case TokenType::LE:
+            case TokenType::GE: case TokenType::EQ: case TokenType::NE:
+            case TokenType::PLUS: case TokenType::MINUS:
+            case TokenType::TIMES: case TokenType::DIVIDE:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void parseFactor() {
+        switch (token.type) {
+            case TokenType::NUMBER:
+            case TokenType::STRING_LITERAL:
+                derived().onEnter(ASTNodeType::Factor);
+                advance();
+                derived().onLeave(ASTNodeType::Factor);
+                return;
+            case TokenType::IDENT:
+                derived().onEnter(ASTNodeType::Factor);
+                advance();
+                if (at(TokenType::LPAREN)) {
+                    advance();
+                    parseArguments();
+                }
+                derived().onLeave(ASTNodeType::Factor);
+                return;
+            case TokenType::LPAREN:
+                advance();
+                parseExpression();
+                expect(TokenType::RPAREN);
+                return;
+            default:
+                throw std::runtime_error("Неожиданный токен в выражении: " + token.lexeme);
+        }
+    }
+};
+
+#endif
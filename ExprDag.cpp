@@ -0,0 +1,130 @@
+#include "ExprDag.h"
+#include "Resolver.h"
+#include "TypeChecker.h"
+#include <cstring>
+
+namespace {
+
+uint64_t mix(uint64_t h, uint64_t value) {
+    // Шаг splitmix64 над h ^ value: соседние номера детей и ячеек хорошо
+    // разбегаются по таблице.
+    h ^= value + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+}
+
+bool isExpressionNode(const ASTNode &node) {
+    return node.type == ASTNodeType::Expression || node.type == ASTNodeType::Term ||
+           node.type == ASTNodeType::Factor;
+}
+
+bool ExprDag::same(const Entry &a, const Entry &b) {
+    return a.hash == b.hash && a.type == b.type && a.factor == b.factor && a.op == b.op &&
+           a.valueType == b.valueType && a.slot == b.slot && a.symbol == b.symbol &&
+           a.number == b.number && a.left == b.left && a.right == b.right;
+}
+
+size_t ExprDag::probe(const Entry &key) const {
+    size_t mask = table.size() - 1;
+    size_t i = static_cast<size_t>(key.hash) & mask;
+    while (table[i] != EMPTY && !same(entries[table[i]], key)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+uint32_t ExprDag::intern(const std::shared_ptr<ASTNode> &node, uint32_t left, uint32_t right) {
+    Entry key{0, node->type, node->factor, BinaryOp::Invalid, node->valueType, -1, -1, 0, None, None, nullptr};
+    switch (node->type) {
+        case ASTNodeType::Expression:
+        case ASTNodeType::Term:
+            key.op = binaryOp(node->value);
+            if (key.op == BinaryOp::Invalid || left == None || right == None) return None;
+            key.left = left;
+            key.right = right;
+            break;
+        case ASTNodeType::Factor:
+            switch (node->factor) {
+                case FactorKind::Number:
+                    std::memcpy(&key.number, &node->number, sizeof key.number);
+                    break;
+                case FactorKind::Name:
+                    if (node->slot < 0) return None;
+                    // Привязка, а не только ячейка: ячейки соседних областей
+                    // переиспользуются, а склеенный узел разрешается заново.
+                    key.slot = node->slot;
+                    key.symbol = node->symbol;
+                    break;
+                case FactorKind::Call:
+                    if (node->slot < 0 || left == None) return None;
+                    key.slot = node->slot;
+                    key.left = left;
+                    break;
+                default:
+                    return None;
+            }
+            break;
+        default:
+            return None;
+    }
+
+    uint64_t h = mix(static_cast<uint64_t>(key.type), static_cast<uint64_t>(key.factor));
+    h = mix(h, static_cast<uint64_t>(key.op) << 8 | static_cast<uint64_t>(key.valueType));
+    h = mix(h, static_cast<uint64_t>(static_cast<uint32_t>(key.slot)) << 32 | static_cast<uint32_t>(key.symbol));
+    h = mix(h, key.number);
+    h = mix(h, key.left == None ? 0 : entries[key.left].hash);
+    key.hash = mix(h, key.right == None ? 0 : entries[key.right].hash);
+
+    size_t i = probe(key);
+    if (table[i] != EMPTY) return table[i];
+
+    auto id = static_cast<uint32_t>(entries.size());
+    key.node = node;
+    entries.push_back(std::move(key));
+    if (entries.size() * 2 > table.size()) {
+        table.assign(table.size() * 2, EMPTY);
+        for (uint32_t existing = 0; existing < entries.size(); ++existing) {
+            table[probe(entries[existing])] = existing;
+        }
+    } else {
+        table[i] = id;
+    }
+    return id;
+}
+
+uint32_t ExprDag::share(std::shared_ptr<ASTNode> &node) {
+    uint32_t left = None, right = None;
+    if (!node->children.empty()) left = share(node->children[0]);
+    if (node->children.size() > 1) right = share(node->children[1]);
+    uint32_t id = intern(node, left, right);
+    if (id != None) {
+        ++visited;
+        node = entries[id].node;
+    }
+    return id;
+}
+
+namespace {
+
+void shareChildren(ASTNode &node, ExprDag &dag) {
+    for (auto &child: node.children) {
+        if (isExpressionNode(*child)) {
+            dag.share(child);
+        } else {
+            shareChildren(*child, dag);
+        }
+    }
+}
+
+}
+
+DagStats shareExpressions(std::shared_ptr<ASTNode> &root) {
+    Resolution resolution = resolveNames(*root);
+    checkTypes(*root, resolution);
+    ExprDag dag;
+    shareChildren(*root, dag);
+    return {dag.occurrences(), dag.size()};
+}
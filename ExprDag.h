@@ -0,0 +1,70 @@
+#ifndef EXPRDAG_H
+#define EXPRDAG_H
+
+#include "AST.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Хэш-консинг выражений (узлы Expression, Term и Factor после resolveNames и
+// checkTypes). Структурно равные подвыражения — тот же оператор, литерал,
+// привязка имени или встроенная функция, тот же тип и равные дети — получают
+// один номер. Хэш узла строится из хэшей детей, поэтому поиск не обходит
+// поддерево заново.
+class ExprDag {
+public:
+    static constexpr uint32_t None = UINT32_MAX;
+
+    struct Entry {
+        uint64_t hash;
+        ASTNodeType type;
+        FactorKind factor;
+        BinaryOp op;
+        ValueType valueType;
+        int slot;               // ячейка имени или номер встроенной функции
+        int symbol;
+        uint64_t number;        // биты литерала
+        uint32_t left;
+        uint32_t right;
+        std::shared_ptr<ASTNode> node;  // первый встреченный узел с этой структурой
+    };
+
+    // Номер узла по номерам его детей (None, если детей меньше двух).
+    // Строки и неразрешённые имена номера не получают: None.
+    uint32_t intern(const std::shared_ptr<ASTNode> &node, uint32_t left = None, uint32_t right = None);
+
+    // Нумерует поддерево и заменяет его и его части первыми узлами с той же
+    // структурой: дерево выражения становится DAG.
+    uint32_t share(std::shared_ptr<ASTNode> &node);
+
+    const Entry &operator[](uint32_t id) const { return entries[id]; }
+    size_t size() const { return entries.size(); }
+    // Пронумерованных узлов, пройденных share.
+    size_t occurrences() const { return visited; }
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    std::vector<Entry> entries;
+    std::vector<uint32_t> table = std::vector<uint32_t>(64, EMPTY);
+    size_t visited = 0;
+
+    static bool same(const Entry &a, const Entry &b);
+    size_t probe(const Entry &key) const;
+};
+
+bool isExpressionNode(const ASTNode &node);
+
+struct DagStats {
+    size_t nodes = 0;           // узлов выражений в дереве
+    size_t unique = 0;          // осталось после склейки
+};
+
+// Склеивает структурно равные подвыражения всей программы в общие узлы.
+// Исполнители дерево только читают, поэтому DAG им подходит; проходы,
+// которые хранят что-то по адресу узла выражения (SSA, LICM, CSE) или меняют
+// его на месте, нужно запускать до склейки.
+DagStats shareExpressions(std::shared_ptr<ASTNode> &root);
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef FLATMAP_H
+#define FLATMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Хэш-таблица с открытой адресацией (линейное пробирование) для ключей —
+// идентификаторов интернированных имён. Ключи и значения лежат в двух
+// непрерывных массивах, ёмкость — степень двойки, заполнение не выше 1/2.
+// Удаления нет: проходы, которым нужно «забыть» ключ, хранят в значении
+// признак отсутствия.
+template <typename Value>
+class FlatMap {
+public:
+    explicit FlatMap(size_t capacity = 16) {
+        size_t size = 16;
+        while (size < capacity * 2) size *= 2;
+        keys.assign(size, EMPTY);
+        values.resize(size);
+    }
+
+    Value *find(uint32_t key) {
+        size_t i = probe(key);
+        return keys[i] == key ? &values[i] : nullptr;
+    }
+
+    const Value *find(uint32_t key) const {
+        size_t i = probe(key);
+        return keys[i] == key ? &values[i] : nullptr;
+    }
+
+    // Значение по ключу; отсутствующий ключ вставляется со значением Value().
+    Value &operator[](uint32_t key) {
+        size_t i = probe(key);
+        if (keys[i] != key) {
+            if ((count + 1) * 2 > keys.size()) {
+                grow();
+                i = probe(key);
+            }
+            keys[i] = key;
+            values[i] = Value();
+            ++count;
+        }
+        return values[i];
+    }
+
+    size_t size() const { return count; }
+
+    void clear() {
+        std::fill(keys.begin(), keys.end(), EMPTY);
+        count = 0;
+    }
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    std::vector<uint32_t> keys;
+    std::vector<Value> values;
+    size_t count = 0;
+
+    // Позиция ключа или первая пустая ячейка на его пути.
+    size_t probe(uint32_t key) const {
+        size_t mask = keys.size() - 1;
+        size_t i = static_cast<size_t>((key * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+        while (keys[i] != key && keys[i] != EMPTY) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow() {
+        std::vector<uint32_t> oldKeys(keys.size() * 2, EMPTY);
+        std::vector<Value> oldValues(keys.size() * 2);
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        for (size_t i = 0; i < oldKeys.size(); ++i) {
+            if (oldKeys[i] == EMPTY) continue;
+            size_t j = probe(oldKeys[i]);
+            keys[j] = oldKeys[i];
+            values[j] = std::move(oldValues[i]);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,321 @@
+#include "AllocProfile.h"
+#include "AstVisitor.h"
+#include "Corpus.h"
+#include "EventParser.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "PerfCounters.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Микробенчмарки фронтенда по стадиям: лексер (в вектор и потоком),
+// классификация ключевых слов, разбор событиями без AST (EventParser.h),
+// парсер, разбор выражений, удаление AST — на малом, среднем и огромном входе.
+// bench [--repetitions N] [--warmup N] [--sizes small,medium,huge] [--seed N]
+// Выделения памяти за один повтор считаются отдельным прогоном с профилем
+// выделений (AllocProfile.h), чтобы учёт не попадал в замер времени; так же
+// снимаются аппаратные счётчики (PerfCounters.h), если они доступны.
+// Программы генерирует generateCorpus с заданным seed, поэтому входы
+// воспроизводятся без хранения файлов. Результат — JSON в stdout (для
+// сравнения прогонов), таблица — в stderr.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char *HEADER = R"(var a, b, c, y: real;
+begin
+  readln(a, b);
+  c := 0;
+)";
+
+// Длинные выражения со всеми уровнями приоритета и вызовами.
+const char *EXPRESSION_CHUNK = R"(  y := ((a + b) * (c - 3) / (a - 1) + sin(b * 2)) * (c + a * b) - 4 / (1 + cos(a - b * c));
+  c := (y * y + a * (b - c) / 7 - sqrt(a * a + b * b)) * (y - 1) + (a + 2) * (b + 3) * (c + 4);
+)";
+
+std::string makeSource(const char *chunk, size_t bytes) {
+    std::string source = HEADER;
+    do {
+        source += chunk;
+    } while (source.size() < bytes);
+    source += "end.\n";
+    return source;
+}
+
+struct Input {
+    std::string name;
+    std::string source;
+};
+
+struct Counts {
+    size_t bytes = 0;
+    size_t tokens = 0;
+    size_t nodes = 0;
+};
+
+class NodeCounter : public AstVisitor<NodeCounter, const ASTNode> {
+public:
+    size_t nodes = 0;
+
+    bool enterNode(const ASTNode &) {
+        ++nodes;
+        return true;
+    }
+};
+
+struct Options {
+    int repetitions = 15;
+    int warmup = 2;
+    double budgetSeconds = 2.0;     // на один замер; не меньше трёх повторов
+    std::vector<std::string> sizes{"small", "medium", "huge"};
+    uint64_t seed = 1;
+};
+
+struct Result {
+    std::string stage;
+    std::string input;
+    Counts counts;
+    size_t repetitions = 0;
+    double medianNs = 0;
+    double p99Ns = 0;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    HardwareCounters counters{};
+};
+
+// Один повтор: prepare вне замера, run — замеряемая часть.
+struct Case {
+    std::function<void()> prepare;
+    std::function<void()> run;
+};
+
+double percentile(const std::vector<double> &sorted, double p) {
+    // Ближайший ранг: при малом числе повторов p99 — максимум.
+    auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+Result measure(const std::string &stage, const std::string &input, const Counts &counts, const Case &benchCase,
+               const Options &options) {
+    for (int i = 0; i < options.warmup; ++i) {
+        if (benchCase.prepare) benchCase.prepare();
+        benchCase.run();
+    }
+    std::vector<double> samples;
+    double spent = 0;
+    for (int i = 0; i < options.repetitions; ++i) {
+        if (i >= 3 && spent > options.budgetSeconds * 1e9) break;
+        if (benchCase.prepare) benchCase.prepare();
+        auto start = Clock::now();
+        benchCase.run();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        samples.push_back(ns);
+        spent += ns;
+    }
+    std::sort(samples.begin(), samples.end());
+    Result result{stage, input, counts, samples.size(), percentile(samples, 0.5), percentile(samples, 0.99)};
+
+    if (benchCase.prepare) benchCase.prepare();
+    enableAllocProfile(true);
+    AllocCounters before = allocTotals();
+    benchCase.run();
+    AllocCounters after = allocTotals();
+    enableAllocProfile(false);
+    result.allocations = after.allocations - before.allocations;
+    result.allocatedBytes = after.bytes - before.bytes;
+
+    if (const PerfCounters *perf = perfCounters(); perf && perf->available()) {
+        if (benchCase.prepare) benchCase.prepare();
+        HardwareCounters start = perf->read();
+        benchCase.run();
+        result.counters = perf->read() - start;
+    }
+    return result;
+}
+
+double perSecond(size_t count, double ns) {
+    return ns > 0 ? static_cast<double>(count) * 1e9 / ns : 0;
+}
+
+void printJson(const std::vector<Result> &results, const Options &options) {
+    std::printf("{\n  \"warmup\": %d,\n  \"seed\": %llu,\n  \"benchmarks\": [\n", options.warmup,
+                static_cast<unsigned long long>(options.seed));
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result &r = results[i];
+        std::printf("    {\"stage\": \"%s\", \"input\": \"%s\", \"bytes\": %zu, \"tokens\": %zu, \"nodes\": %zu, "
+                    "\"repetitions\": %zu, \"median_ns\": %.0f, \"p99_ns\": %.0f, "
+                    "\"bytes_per_sec\": %.0f, \"tokens_per_sec\": %.0f, \"nodes_per_sec\": %.0f, "
+                    "\"allocations\": %llu, \"allocated_bytes\": %llu",
+                    r.stage.c_str(), r.input.c_str(), r.counts.bytes, r.counts.tokens, r.counts.nodes,
+                    r.repetitions, r.medianNs, r.p99Ns, perSecond(r.counts.bytes, r.medianNs),
+                    perSecond(r.counts.tokens, r.medianNs), perSecond(r.counts.nodes, r.medianNs),
+                    static_cast<unsigned long long>(r.allocations),
+                    static_cast<unsigned long long>(r.allocatedBytes));
+        for (size_t e = 0; e < static_cast<size_t>(HardwareEvent::Count); ++e) {
+            auto event = static_cast<HardwareEvent>(e);
+            if (r.counters.has(event)) {
+                std::printf(", \"%s\": %llu", hardwareEventName(event),
+                            static_cast<unsigned long long>(r.counters[event]));
+            }
+        }
+        std::printf("}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+}
+
+void printTable(const std::vector<Result> &results) {
+    std::fprintf(stderr, "%-11s %-7s %10s %12s %12s %10s %10s %12s %10s %6s\n", "стадия", "вход", "повторов",
+                 "медиана мкс", "p99 мкс", "МБ/с", "Мтокенов/с", "выделений", "МБ выдел.", "IPC");
+    for (const Result &r: results) {
+        std::fprintf(stderr, "%-11s %-7s %10zu %12.1f %12.1f %10.1f %10.2f %12llu %10.1f %6.2f\n", r.stage.c_str(),
+                     r.input.c_str(), r.repetitions, r.medianNs / 1e3, r.p99Ns / 1e3,
+                     perSecond(r.counts.bytes, r.medianNs) / 1e6, perSecond(r.counts.tokens, r.medianNs) / 1e6,
+                     static_cast<unsigned long long>(r.allocations), static_cast<double>(r.allocatedBytes) / (1 << 20),
+                     r.counters.ipc());
+    }
+}
+
+volatile size_t sink = 0;
+
+// Разбор событиями: обработчик только считает узлы.
+class EventCounter : public EventParser<EventCounter> {
+public:
+    size_t nodes = 0;
+
+    void onEnter(ASTNodeType) { ++nodes; }
+};
+
+void benchInput(const Input &input, const std::string &kind, const Options &options, std::vector<Result> &results) {
+    std::vector<Token> tokens = Lexer(input.source).tokenize();
+    std::shared_ptr<ASTNode> ast = Parser(tokens).parse();
+    NodeCounter counter;
+    counter.traverse(*ast);
+    Counts counts{input.source.size(), tokens.size(), counter.nodes};
+    std::string name = input.name;
+
+    if (kind == "expression") {
+        // Вход из одних присваиваний: время разбора — в основном выражения.
+        results.push_back(measure("expression", name, counts, {
+                [&] { ast.reset(); },
+                [&] { ast = Parser(tokens).parse(); }
+        }, options));
+        return;
+    }
+
+    results.push_back(measure("tokenize", name, counts, {
+            nullptr,
+            [&] { sink = sink + Lexer(input.source).tokenize().size(); }
+    }, options));
+
+    results.push_back(measure("stream", name, counts, {
+            nullptr,
+            [&] {
+                Lexer lexer(input.source);
+                size_t count = 1;
+                while (lexer.next().type != TokenType::END_OF_FILE) ++count;
+                sink = sink + count;
+            }
+    }, options));
+
+    results.push_back(measure("events", name, counts, {
+            nullptr,
+            [&] {
+                Lexer lexer(input.source);
+                EventCounter events;
+                events.parse(lexer);
+                sink = sink + events.nodes;
+            }
+    }, options));
+
+    std::vector<std::string> words;
+    Counts wordCounts;
+    for (const Token &token: tokens) {
+        if (token.type == TokenType::IDENT || keywordType(token.lexeme) != TokenType::IDENT) {
+            words.push_back(token.lexeme);
+            wordCounts.bytes += token.lexeme.size();
+        }
+    }
+    wordCounts.tokens = words.size();
+    results.push_back(measure("keywords", name, wordCounts, {
+            nullptr,
+            [&] {
+                size_t keywords = 0;
+                for (const auto &word: words) keywords += keywordType(word) != TokenType::IDENT;
+                sink = sink + keywords;
+            }
+    }, options));
+
+    // Удаление прошлого дерева — вне замера разбора, само — отдельный замер.
+    results.push_back(measure("parse", name, counts, {
+            [&] { ast.reset(); },
+            [&] { ast = Parser(tokens).parse(); }
+    }, options));
+
+    results.push_back(measure("teardown", name, counts, {
+            [&] { if (!ast) ast = Parser(tokens).parse(); },
+            [&] { ast.reset(); }
+    }, options));
+}
+
+size_t sizeBytes(const std::string &size) {
+    if (size == "small") return 512;
+    if (size == "medium") return 64 << 10;
+    return 8 << 20;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--repetitions" && i + 1 < argc) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--sizes" && i + 1 < argc) {
+            options.sizes.clear();
+            std::string list = argv[++i];
+            for (size_t start = 0; start <= list.size();) {
+                size_t comma = std::min(list.find(',', start), list.size());
+                if (comma > start) options.sizes.push_back(list.substr(start, comma - start));
+                start = comma + 1;
+            }
+        } else {
+            std::fprintf(stderr, "bench [--repetitions N] [--warmup N] [--sizes small,medium,huge] [--seed N]\n");
+            return 2;
+        }
+    }
+
+    enablePerfCounters(true);
+    if (!perfCounters()->unavailableReason().empty()) {
+        std::fprintf(stderr, "Часть аппаратных счётчиков недоступна (%s)\n",
+                     perfCounters()->unavailableReason().c_str());
+    }
+
+    std::vector<Result> results;
+    for (const auto &size: options.sizes) {
+        if (size != "small" && size != "medium" && size != "huge") {
+            std::fprintf(stderr, "Неизвестный размер входа: %s\n", size.c_str());
+            return 2;
+        }
+        CorpusOptions corpus;
+        corpus.bytes = sizeBytes(size);
+        corpus.seed = options.seed;
+        benchInput({size, generateCorpus(corpus)}, "program", options, results);
+        benchInput({size, makeSource(EXPRESSION_CHUNK, sizeBytes(size))}, "expression", options, results);
+    }
+    printTable(results);
+    printJson(results, options);
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include "Interner.h"
+
+uint64_t Interner::hash(std::string_view name) {
+    // FNV-1a: имена короткие, важнее простота, чем скорость на длинных строках.
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c: name) {
+        h = (h ^ c) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+size_t Interner::probe(std::string_view name, uint64_t h) const {
+    size_t mask = table.size() - 1;
+    size_t i = static_cast<size_t>(h) & mask;
+    while (table[i] != EMPTY && (hashes[table[i]] != h || names[table[i]] != name)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+uint32_t Interner::find(std::string_view name) const {
+    return table[probe(name, hash(name))];
+}
+
+uint32_t Interner::intern(std::string_view name) {
+    uint64_t h = hash(name);
+    size_t i = probe(name, h);
+    if (table[i] != EMPTY) return table[i];
+
+    auto id = static_cast<uint32_t>(names.size());
+    names.emplace_back(name);
+    hashes.push_back(h);
+    if (names.size() * 2 > table.size()) {
+        table.assign(table.size() * 2, EMPTY);
+        for (uint32_t existing = 0; existing < names.size(); ++existing) {
+            table[probe(names[existing], hashes[existing])] = existing;
+        }
+    } else {
+        table[i] = id;
+    }
+    return id;
+}
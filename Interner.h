@@ -0,0 +1,34 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Интернирование имён: каждой различной строке — плотный номер с нуля.
+// Дальше проходы сравнивают и хэшируют номера, а не строки.
+class Interner {
+public:
+    uint32_t intern(std::string_view name);
+
+    // Номер имени или UINT32_MAX, если оно не встречалось.
+    uint32_t find(std::string_view name) const;
+
+    const std::string &name(uint32_t id) const { return names[id]; }
+
+    size_t size() const { return names.size(); }
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    std::vector<std::string> names;
+    std::vector<uint64_t> hashes;           // хэш каждого имени, по номеру
+    std::vector<uint32_t> table = std::vector<uint32_t>(64, EMPTY);
+
+    static uint64_t hash(std::string_view name);
+    size_t probe(std::string_view name, uint64_t h) const;
+};
+
+#endif
@@ -0,0 +1,144 @@
+#include "Interpreter.h"
+#include "Builtins.h"
+#include "TypeChecker.h"
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+Interpreter::Interpreter(std::istream &in, OutputBuffer &out) : in(in), out(out) {}
+
+RunStats Interpreter::run(ASTNode &program) {
+    using Clock = std::chrono::steady_clock;
+    RunStats stats;
+
+    auto start = Clock::now();
+    Resolution resolution = resolveNames(program);
+    checkTypes(program, resolution);
+    slots = std::move(resolution.initialFrame);
+    auto resolved = Clock::now();
+
+    statements = 0;
+    execute(program);
+    out.flush();
+    auto finished = Clock::now();
+
+    stats.resolveMs = std::chrono::duration<double, std::milli>(resolved - start).count();
+    stats.executeMs = std::chrono::duration<double, std::milli>(finished - resolved).count();
+    stats.statements = statements;
+    return stats;
+}
+
+void Interpreter::execute(const ASTNode &node) {
+    switch (node.type) {
+        case ASTNodeType::Program:
+        case ASTNodeType::Block:
+        case ASTNodeType::StatementBlock:
+            for (const auto &child: node.children) {
+                execute(*child);
+            }
+            return;
+        case ASTNodeType::VarDecl: {
+            ++statements;
+            // Без инициализатора переменная обнуляется: в теле цикла каждая
+            // итерация начинает с нуля, а не со значения прошлой.
+            double value = node.children.empty() ? 0.0 : evaluate(*node.children[0]);
+            size_t count = declaredNames(node).size();
+            for (size_t i = 0; i < count; ++i) {
+                slots[node.slot + i] = value;
+            }
+            return;
+        }
+        case ASTNodeType::Assignment:
+            ++statements;
+            slots[node.slot] = evaluate(*node.children[0]);
+            return;
+        case ASTNodeType::IfStatement:
+            ++statements;
+            if (evaluate(*node.children[0]) != 0.0) {
+                execute(*node.children[1]);
+            } else if (node.children.size() > 2) {
+                execute(*node.children[2]);
+            }
+            return;
+        case ASTNodeType::WhileStatement:
+            ++statements;
+            if (loopHook) {
+                for (uint64_t iteration = 0;; ++iteration) {
+                    if (loopHook(node, slots.data(), iteration)) return;
+                    if (evaluate(*node.children[0]) == 0.0) return;
+                    execute(*node.children[1]);
+                }
+            }
+            while (evaluate(*node.children[0]) != 0.0) {
+                execute(*node.children[1]);
+            }
+            return;
+        case ASTNodeType::ProcedureCall:
+            ++statements;
+            callProcedure(node);
+            return;
+        default:
+            // Константы уже в кадре, шаблоны и пустые операторы ничего не делают.
+            return;
+    }
+}
+
+double Interpreter::evaluate(const ASTNode &node) {
+    switch (node.type) {
+        case ASTNodeType::Expression:
+        case ASTNodeType::Term:
+            return applyBinary(binaryOp(node.value), evaluate(*node.children[0]), evaluate(*node.children[1]));
+        case ASTNodeType::Factor:
+            switch (node.factor) {
+                case FactorKind::Number:
+                    return node.number;
+                case FactorKind::Name:
+                    return slots[node.slot];
+                case FactorKind::Call:
+                    return BUILTINS[node.slot].fn(evaluate(*node.children[0]));
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+    throw std::runtime_error("Невычислимое выражение: " + node.value);
+}
+
+void Interpreter::callProcedure(const ASTNode &node) {
+    switch (static_cast<Procedure>(node.slot)) {
+        case Procedure::Write:
+        case Procedure::Writeln:
+            for (const auto &arg: node.children) {
+                if (arg->type == ASTNodeType::Factor && arg->factor == FactorKind::String) {
+                    out.append(arg->value);
+                } else {
+                    out.number(evaluate(*arg));
+                }
+            }
+            if (static_cast<Procedure>(node.slot) == Procedure::Writeln) out.put('\n');
+            return;
+        case Procedure::Readln:
+            // Приглашение к вводу должно появиться до ожидания.
+            out.flush();
+            for (const auto &arg: node.children) {
+                double value;
+                if (!(in >> value)) {
+                    throw std::runtime_error("Ожидалось число при вводе в " + arg->value);
+                }
+                if (arg->valueType == ValueType::Integer && value != std::trunc(value)) {
+                    throw std::runtime_error("Ожидалось целое число при вводе в " + arg->value);
+                }
+                slots[arg->slot] = value;
+            }
+            return;
+        case Procedure::Assert:
+            for (const auto &arg: node.children) {
+                if (evaluate(*arg) == 0.0) {
+                    throw std::runtime_error("Нарушено утверждение assert");
+                }
+            }
+            return;
+    }
+}
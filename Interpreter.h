@@ -0,0 +1,49 @@
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include "AST.h"
+#include "OutputBuffer.h"
+#include "Resolver.h"
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <vector>
+
+struct RunStats {
+    double resolveMs = 0.0;
+    double executeMs = 0.0;
+    uint64_t statements = 0;    // выполнено операторов
+};
+
+// Базовый исполнитель: обходит AST напрямую. Имена заранее разрешены в
+// ячейки кадра, значения — double (сравнения дают 1/0).
+class Interpreter {
+public:
+    Interpreter(std::istream &in, OutputBuffer &out);
+
+    RunStats run(ASTNode &program);
+
+    const std::vector<double> &frame() const { return slots; }
+
+    // Вызывается в заголовке цикла while перед каждой проверкой условия:
+    // iteration == 0 при входе, далее — номер обратного перехода. Если
+    // обработчик вернул true, остаток цикла он выполнил сам (например,
+    // машинным кодом над тем же кадром), и интерпретатор выходит из цикла.
+    using LoopHook = std::function<bool(const ASTNode &loop, double *frame, uint64_t iteration)>;
+    void setLoopHook(LoopHook hook) { loopHook = std::move(hook); }
+
+    uint64_t executedStatements() const { return statements; }
+
+private:
+    std::istream &in;
+    OutputBuffer &out;
+    std::vector<double> slots;
+    uint64_t statements = 0;
+    LoopHook loopHook;
+
+    void execute(const ASTNode &node);
+    double evaluate(const ASTNode &node);
+    void callProcedure(const ASTNode &node);
+};
+
+#endif
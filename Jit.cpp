@@ -0,0 +1,366 @@
+#include "Jit.h"
+#include "Builtins.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__))
+#define SA_JIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+NativeCode::NativeCode(void *region, size_t regionSize, Entry entry, size_t codeSize)
+        : region(region), regionSize(regionSize), entry(entry), bytes(codeSize) {}
+
+NativeCode::~NativeCode() {
+#ifdef SA_JIT_X86_64
+    munmap(region, regionSize);
+#endif
+}
+
+bool jitSupported() {
+#ifdef SA_JIT_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef SA_JIT_X86_64
+
+namespace {
+
+// Регистры общего назначения (младшие три бита кода).
+constexpr int RSP = 4;
+constexpr int RBX = 3;      // указатель на кадр
+constexpr int RBP = 5;      // указатель на пул констант
+
+// xmm0..xmm13 — стек операндов, xmm15 — рабочий регистр.
+constexpr size_t MAX_STACK = 14;
+constexpr int SCRATCH = 15;
+constexpr int32_t SPILL_AREA = 136;
+
+enum CmpPredicate : uint8_t {
+    CMP_EQ = 0,
+    CMP_LT = 1,
+    CMP_LE = 2,
+    CMP_NEQ = 4
+};
+
+class Assembler {
+public:
+    std::vector<uint8_t> code;
+
+    void byte(uint8_t b) { code.push_back(b); }
+
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; ++i) byte(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void u64(uint64_t v) {
+        for (int i = 0; i < 8; ++i) byte(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    // op xmm(reg), xmm(rm)
+    void sse(uint8_t prefix, uint8_t op, int reg, int rm) {
+        byte(prefix);
+        if (reg >= 8 || rm >= 8) byte(0x40 | (reg >= 8 ? 4 : 0) | (rm >= 8 ? 1 : 0));
+        byte(0x0F);
+        byte(op);
+        byte(static_cast<uint8_t>(0xC0 | (reg & 7) << 3 | (rm & 7)));
+    }
+
+    // op xmm(reg), [base + disp32]
+    void sseMem(uint8_t prefix, uint8_t op, int reg, int base, int32_t disp) {
+        byte(prefix);
+        if (reg >= 8) byte(0x44);
+        byte(0x0F);
+        byte(op);
+        byte(static_cast<uint8_t>(0x80 | (reg & 7) << 3 | base));
+        if (base == RSP) byte(0x24);
+        u32(static_cast<uint32_t>(disp));
+    }
+
+    void loadDouble(int xmm, int base, int32_t disp) { sseMem(0xF2, 0x10, xmm, base, disp); }
+
+    void storeDouble(int xmm, int base, int32_t disp) { sseMem(0xF2, 0x11, xmm, base, disp); }
+
+    void move(int dst, int src) {
+        if (dst != src) sse(0x66, 0x28, dst, src);
+    }
+
+    void compare(int dst, int src, CmpPredicate predicate) {
+        sse(0xF2, 0xC2, dst, src);
+        byte(predicate);
+    }
+
+    // Маска сравнения -> 1.0 или 0.0 (константа 1.0 лежит в начале пула).
+    void maskToOne(int xmm) { sseMem(0x66, 0x54, xmm, RBP, 0); }
+
+    // Переход с 32-битным смещением; возвращает позицию смещения для правки.
+    size_t jump(uint8_t conditionCode = 0) {
+        if (conditionCode == 0) {
+            byte(0xE9);
+        } else {
+            byte(0x0F);
+            byte(conditionCode);
+        }
+        size_t at = code.size();
+        u32(0);
+        return at;
+    }
+
+    void patch(size_t at, size_t target) {
+        auto rel = static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(at + 4));
+        std::memcpy(&code[at], &rel, sizeof rel);
+    }
+};
+
+constexpr uint8_t JE = 0x84;
+constexpr uint8_t JNE = 0x85;
+constexpr uint8_t JP = 0x8A;
+
+}
+
+std::unique_ptr<NativeCode> compileNative(const Chunk &chunk) {
+    if (chunk.maxStack > MAX_STACK || chunk.code.empty()) return nullptr;
+
+    // Пул: 16 байт под выровненную маску 1.0 для andpd, затем константы.
+    std::vector<double> data{1.0, 0.0};
+    data.insert(data.end(), chunk.constants.begin(), chunk.constants.end());
+
+    Assembler as;
+    // Пролог: rbx — кадр, rbp — пул (адрес пула известен после mmap, правим позже).
+    as.byte(0x53);                          // push rbx
+    as.byte(0x55);                          // push rbp
+    as.byte(0x48); as.byte(0x81); as.byte(0xEC); as.u32(SPILL_AREA);   // sub rsp, imm32
+    as.byte(0x48); as.byte(0x89); as.byte(0xFB);                       // mov rbx, rdi
+    as.byte(0x48); as.byte(0xBD);                                      // mov rbp, imm64
+    size_t poolAddress = as.code.size();
+    as.u64(0);
+
+    std::vector<size_t> offsets(chunk.code.size() + 1);
+    std::vector<std::pair<size_t, size_t>> fixups;      // (позиция смещения, команда)
+    std::vector<bool> isTarget(chunk.code.size() + 1, false);
+    for (const auto &ins: chunk.code) {
+        if (isJump(ins.op)) {
+            if (ins.a > chunk.code.size()) return nullptr;
+            isTarget[ins.a] = true;
+        }
+    }
+
+    // Сравнение двух верхних значений: результат 1.0 или 0.0 в xmm(top - 1).
+    auto compare = [&](OpCode op, int top) {
+        if (op == OpCode::Gt || op == OpCode::Ge) {
+            // a > b  <=>  b < a
+            as.move(SCRATCH, top);
+            as.compare(SCRATCH, top - 1, op == OpCode::Gt ? CMP_LT : CMP_LE);
+            as.maskToOne(SCRATCH);
+            as.move(top - 1, SCRATCH);
+            return;
+        }
+        CmpPredicate predicate = op == OpCode::Lt ? CMP_LT :
+                                 op == OpCode::Le ? CMP_LE :
+                                 op == OpCode::Eq ? CMP_EQ : CMP_NEQ;
+        as.compare(top - 1, top, predicate);
+        as.maskToOne(top - 1);
+    };
+    // Условный переход по значению в xmm(reg); NaN — истина.
+    auto branch = [&](bool ifTrue, int reg, uint32_t target) {
+        as.sse(0x66, 0x57, SCRATCH, SCRATCH);                           // xorpd
+        as.sse(0x66, 0x2E, reg, SCRATCH);                               // ucomisd
+        if (!ifTrue) {
+            // Переход только при ZF=1 и PF=0.
+            as.byte(0x7A); as.byte(0x06);                                // jp +6
+            fixups.emplace_back(as.jump(JE), target);
+        } else {
+            fixups.emplace_back(as.jump(JNE), target);
+            fixups.emplace_back(as.jump(JP), target);
+        }
+    };
+    auto constant = [](uint32_t index) { return static_cast<int32_t>(8 * (index + 2)); };
+    auto slot = [](uint32_t index) { return static_cast<int32_t>(8 * index); };
+
+    size_t depth = 0;
+    for (size_t i = 0; i < chunk.code.size(); ++i) {
+        const Instruction &ins = chunk.code[i];
+        offsets[i] = as.code.size();
+        // Между операторами стек пуст; только в таких точках возможны переходы.
+        if (isTarget[i] && depth != 0) return nullptr;
+        int top = static_cast<int>(depth) - 1;
+
+        switch (ins.op) {
+            case OpCode::PushConst:
+                as.loadDouble(static_cast<int>(depth), RBP, constant(ins.a));
+                ++depth;
+                break;
+            case OpCode::Load:
+                as.loadDouble(static_cast<int>(depth), RBX, slot(ins.a));
+                ++depth;
+                break;
+            case OpCode::Store:
+                as.storeDouble(top, RBX, slot(ins.a));
+                --depth;
+                break;
+            case OpCode::Add:
+                as.sse(0xF2, 0x58, top - 1, top);
+                --depth;
+                break;
+            case OpCode::Sub:
+                as.sse(0xF2, 0x5C, top - 1, top);
+                --depth;
+                break;
+            case OpCode::Mul:
+                as.sse(0xF2, 0x59, top - 1, top);
+                --depth;
+                break;
+            case OpCode::Div:
+                as.sse(0xF2, 0x5E, top - 1, top);
+                --depth;
+                break;
+            case OpCode::Lt:
+            case OpCode::Gt:
+            case OpCode::Le:
+            case OpCode::Ge:
+            case OpCode::Eq:
+            case OpCode::Ne:
+                compare(ins.op, top);
+                --depth;
+                break;
+            case OpCode::CallBuiltin: {
+                // По System V все регистры XMM затираются вызовом: сохраняем
+                // нижнюю часть стека операндов в области сброса.
+                for (int r = 0; r < top; ++r) as.storeDouble(r, RSP, 8 * r);
+                as.move(0, top);
+                as.byte(0x48); as.byte(0xB8);                            // mov rax, imm64
+                as.u64(reinterpret_cast<uint64_t>(BUILTINS[ins.a].fn));
+                as.byte(0xFF); as.byte(0xD0);                            // call rax
+                as.move(top, 0);
+                for (int r = 0; r < top; ++r) as.loadDouble(r, RSP, 8 * r);
+                break;
+            }
+            case OpCode::Jump:
+                if (depth != 0) return nullptr;
+                fixups.emplace_back(as.jump(), ins.a);
+                break;
+            case OpCode::JumpIfFalse:
+            case OpCode::JumpIfTrue:
+                --depth;
+                if (depth != 0) return nullptr;
+                branch(ins.op == OpCode::JumpIfTrue, top, ins.a);
+                break;
+            case OpCode::Halt:
+                fixups.emplace_back(as.jump(), chunk.code.size());
+                depth = 0;
+                break;
+            case OpCode::LoadLoad:
+                as.loadDouble(top + 1, RBX, slot(ins.a));
+                as.loadDouble(top + 2, RBX, slot(ins.b));
+                depth += 2;
+                break;
+            case OpCode::LoadLoadAdd:
+            case OpCode::LoadLoadSub:
+            case OpCode::LoadLoadMul: {
+                uint8_t op = ins.op == OpCode::LoadLoadAdd ? 0x58 : ins.op == OpCode::LoadLoadSub ? 0x5C : 0x59;
+                as.loadDouble(top + 1, RBX, slot(ins.a));
+                as.sseMem(0xF2, op, top + 1, RBX, slot(ins.b));
+                ++depth;
+                break;
+            }
+            case OpCode::StoreLoad:
+                as.storeDouble(top, RBX, slot(ins.a));
+                as.loadDouble(top, RBX, slot(ins.b));
+                break;
+            case OpCode::Move:
+                as.loadDouble(SCRATCH, RBX, slot(ins.a));
+                as.storeDouble(SCRATCH, RBX, slot(ins.b));
+                break;
+            case OpCode::AddConst:
+                as.sseMem(0xF2, 0x58, top, RBP, constant(ins.a));
+                break;
+            case OpCode::SubConst:
+                as.sseMem(0xF2, 0x5C, top, RBP, constant(ins.a));
+                break;
+            case OpCode::MulConst:
+                as.sseMem(0xF2, 0x59, top, RBP, constant(ins.a));
+                break;
+            case OpCode::DivConst:
+                as.sseMem(0xF2, 0x5E, top, RBP, constant(ins.a));
+                break;
+            case OpCode::CmpJumpIfFalse:
+            case OpCode::CmpJumpIfTrue:
+                compare(static_cast<OpCode>(static_cast<uint32_t>(OpCode::Add) + ins.b), top);
+                depth -= 2;
+                if (depth != 0) return nullptr;
+                branch(ins.op == OpCode::CmpJumpIfTrue, top - 1, ins.a);
+                break;
+            case OpCode::IncSlot:
+                as.loadDouble(SCRATCH, RBX, slot(ins.a));
+                as.sseMem(0xF2, 0x58, SCRATCH, RBP, constant(ins.b));
+                as.storeDouble(SCRATCH, RBX, slot(ins.a));
+                break;
+            default:
+                return nullptr;
+        }
+    }
+
+    // Эпилог.
+    offsets[chunk.code.size()] = as.code.size();
+    as.byte(0x48); as.byte(0x81); as.byte(0xC4); as.u32(SPILL_AREA);   // add rsp, imm32
+    as.byte(0x5D);                          // pop rbp
+    as.byte(0x5B);                          // pop rbx
+    as.byte(0xC3);                          // ret
+
+    for (const auto &[at, target]: fixups) {
+        as.patch(at, offsets[target]);
+    }
+
+    size_t dataBytes = data.size() * sizeof(double);
+    size_t codeStart = (dataBytes + 15) & ~size_t(15);
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t regionSize = (codeStart + as.code.size() + page - 1) / page * page;
+    void *region = mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) return nullptr;
+
+    auto *base = static_cast<uint8_t *>(region);
+    auto pool = reinterpret_cast<uint64_t>(base);
+    std::memcpy(&as.code[poolAddress], &pool, sizeof pool);
+    std::memcpy(base, data.data(), dataBytes);
+    std::memcpy(base + codeStart, as.code.data(), as.code.size());
+    if (mprotect(region, regionSize, PROT_READ | PROT_EXEC) != 0) {
+        munmap(region, regionSize);
+        return nullptr;
+    }
+
+    auto entry = reinterpret_cast<NativeCode::Entry>(base + codeStart);
+    return std::make_unique<NativeCode>(region, regionSize, entry, as.code.size());
+}
+
+#else
+
+std::unique_ptr<NativeCode> compileNative(const Chunk &) {
+    return nullptr;
+}
+
+#endif
+
+RunStats runWithJit(ASTNode &program, std::istream &in, OutputBuffer &out) {
+    // Результат компиляции запоминается и для неудачных попыток (nullptr).
+    std::unordered_map<const ASTNode *, std::unique_ptr<NativeCode>> loops;
+    Interpreter interpreter(in, out);
+    interpreter.setLoopHook([&](const ASTNode &loop, double *frame, uint64_t iteration) {
+        if (iteration > 0) return false;
+        auto it = loops.find(&loop);
+        if (it == loops.end()) {
+            Chunk chunk = compileStatement(loop, interpreter.frame().size());
+            it = loops.emplace(&loop, compileNative(chunk)).first;
+        }
+        if (!it->second) return false;
+        (*it->second)(frame);
+        return true;
+    });
+    return interpreter.run(program);
+}
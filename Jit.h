@@ -0,0 +1,48 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "AST.h"
+#include "Bytecode.h"
+#include "Interpreter.h"
+#include "OutputBuffer.h"
+#include <cstddef>
+#include <istream>
+#include <memory>
+
+// Машинный код, полученный из фрагмента байткода. Страницы выделяются через
+// mmap, заполняются и только затем становятся исполняемыми (W^X).
+class NativeCode {
+public:
+    using Entry = void (*)(double *frame);
+
+    NativeCode(void *region, size_t regionSize, Entry entry, size_t codeSize);
+    ~NativeCode();
+
+    NativeCode(const NativeCode &) = delete;
+    NativeCode &operator=(const NativeCode &) = delete;
+
+    void operator()(double *frame) const { entry(frame); }
+
+    size_t codeSize() const { return bytes; }
+
+private:
+    void *region;
+    size_t regionSize;
+    Entry entry;
+    size_t bytes;
+};
+
+// true, если JIT работает на этой платформе (x86-64, POSIX).
+bool jitSupported();
+
+// Переводит фрагмент в машинный код x86-64 с SSE2: значения стека операндов
+// живут в регистрах XMM, переменные — в кадре. Возвращает nullptr, если во
+// фрагменте есть ввод-вывод, assert или слишком глубокие выражения — такой
+// фрагмент остаётся интерпретатору.
+std::unique_ptr<NativeCode> compileNative(const Chunk &chunk);
+
+// Выполняет программу интерпретатором, переводя каждый цикл while в машинный
+// код при первом входе; неподдерживаемые циклы интерпретируются.
+RunStats runWithJit(ASTNode &program, std::istream &in, OutputBuffer &out);
+
+#endif
@@ -2,6 +2,52 @@
 #include <cctype>
 #include <stdexcept>
 
+const char* tokenTypeName(TokenType type) {
+    switch (type) {
+        case TokenType::CONST: return "CONST";
+        case TokenType::VAR: return "VAR";
+        case TokenType::BEGIN: return "BEGIN";
+        case TokenType::END: return "END";
+        case TokenType::TEMPLATE: return "TEMPLATE";
+        case TokenType::CLASS: return "CLASS";
+        case TokenType::TYPENAME: return "TYPENAME";
+        case TokenType::ASSERT: return "ASSERT";
+        case TokenType::WHILE: return "WHILE";
+        case TokenType::IF: return "IF";
+        case TokenType::ELSE: return "ELSE";
+        case TokenType::DO: return "DO";
+        case TokenType::READLN: return "READLN";
+        case TokenType::WRITELN: return "WRITELN";
+        case TokenType::WRITE: return "WRITE";
+        case TokenType::THEN: return "THEN";
+        case TokenType::PLUS: return "PLUS";
+        case TokenType::MINUS: return "MINUS";
+        case TokenType::TIMES: return "TIMES";
+        case TokenType::DIVIDE: return "DIVIDE";
+        case TokenType::EQ: return "EQ";
+        case TokenType::NE: return "NE";
+        case TokenType::LT: return "LT";
+        case TokenType::GT: return "GT";
+        case TokenType::LE: return "LE";
+        case TokenType::GE: return "GE";
+        case TokenType::ASSIGN: return "ASSIGN";
+        case TokenType::COLON: return "COLON";
+        case TokenType::LPAREN: return "LPAREN";
+        case TokenType::RPAREN: return "RPAREN";
+        case TokenType::LBRACE: return "LBRACE";
+        case TokenType::RBRACE: return "RBRACE";
+        case TokenType::COMMA: return "COMMA";
+        case TokenType::SEMI: return "SEMI";
+        case TokenType::DOT: return "DOT";
+        case TokenType::NUMBER: return "NUMBER";
+        case TokenType::STRING_LITERAL: return "STRING_LITERAL";
+        case TokenType::IDENT: return "IDENT";
+        case TokenType::END_OF_FILE: return "END_OF_FILE";
+        case TokenType::UNKNOWN: return "UNKNOWN";
+    }
+    return "UNKNOWN";
+}
+
 Lexer::Lexer(const std::string& input)
         : input(input), pos(0), length(input.size()), currentLine(1) {}
 
@@ -49,6 +95,26 @@ Token Lexer::number() {
     return Token(TokenType::NUMBER, numStr, value, line);
 }
 
+TokenType keywordType(std::string_view word) {
+    if (word == "const") return TokenType::CONST;
+    if (word == "var") return TokenType::VAR;
+    if (word == "begin") return TokenType::BEGIN;
+    if (word == "end") return TokenType::END;
+    if (word == "template") return TokenType::TEMPLATE;
+    if (word == "class") return TokenType::CLASS;
+    if (word == "typename") return TokenType::TYPENAME;
+    if (word == "assert") return TokenType::ASSERT;
+    if (word == "while") return TokenType::WHILE;
+    if (word == "if") return TokenType::IF;
+    if (word == "else") return TokenType::ELSE;
+    if (word == "do") return TokenType::DO;
+    if (word == "readln") return TokenType::READLN;
+    if (word == "writeln") return TokenType::WRITELN;
+    if (word == "write") return TokenType::WRITE;
+    if (word == "then") return TokenType::THEN;
+    return TokenType::IDENT;
+}
+
 Token Lexer::identifier() {
     size_t line = currentLine;
     size_t start = pos;
@@ -59,25 +125,7 @@ Token Lexer::identifier() {
 
     std::string idStr = input.substr(start, pos - start);
 
-    if (idStr == "const") return Token(TokenType::CONST, idStr, 0.0, line);
-    if (idStr == "var") return Token(TokenType::VAR, idStr, 0.0, line);
-    if (idStr == "begin") return Token(TokenType::BEGIN, idStr, 0.0, line);
-    if (idStr == "end") return Token(TokenType::END, idStr, 0.0, line);
-    if (idStr == "template") return Token(TokenType::TEMPLATE, idStr, 0.0, line);
-    if (idStr == "class") return Token(TokenType::CLASS, idStr, 0.0, line);
-    if (idStr == "typename") return Token(TokenType::TYPENAME, idStr, 0.0, line);
-    if (idStr == "assert") return Token(TokenType::ASSERT, idStr, 0.0, line);
-    if (idStr == "while") return Token(TokenType::WHILE, idStr, 0.0, line);
-    if (idStr == "if") return Token(TokenType::IF, idStr, 0.0, line);
-    if (idStr == "else") return Token(TokenType::ELSE, idStr, 0.0, line);
-    if (idStr == "do") return Token(TokenType::DO, idStr, 0.0, line);
-    if (idStr == "readln") return Token(TokenType::READLN, idStr, 0.0, line);
-    if (idStr == "writeln") return Token(TokenType::WRITELN, idStr, 0.0, line);
-    if (idStr == "write") return Token(TokenType::WRITE, idStr, 0.0, line);
-    if (idStr == "then") return Token(TokenType::THEN, idStr, 0.0, line);
-    if (idStr == "real") return Token(TokenType::IDENT, idStr, 0.0, line);
-
-    return Token(TokenType::IDENT, idStr, 0.0, line);
+    return Token(keywordType(idStr), idStr, 0.0, line);
 }
 
 Token Lexer::getNextToken() {
@@ -158,6 +206,7 @@ Token Lexer::getNextToken() {
         case '.': advance(); return Token(TokenType::DOT, ".", 0.0, line);
         default:
             advance();
+            STATS(++statistics.unknown;)
             return Token(TokenType::UNKNOWN, std::string(1, c), 0.0, line);
     }
 }
@@ -170,5 +219,18 @@ std::vector<Token> Lexer::tokenize() {
         token = getNextToken();
     }
     tokens.push_back(token);
+    STATS(statistics.tokens += tokens.size(); statistics.bytes += length; statistics.lines = currentLine;)
     return tokens;
-}
\ No newline at end of file
+}
+
+Token Lexer::next() {
+    Token token = getNextToken();
+    STATS(
+        ++statistics.tokens;
+        if (token.type == TokenType::END_OF_FILE) {
+            statistics.bytes = length;
+            statistics.lines = currentLine;
+        }
+    )
+    return token;
+}
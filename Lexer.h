@@ -2,9 +2,11 @@
 #define LEXER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stdexcept>
 #include "BoundedDeque.h"
+#include "Stats.h"
 
 constexpr size_t LOOKAHEAD_BUFFER_SIZE = 5;
 
@@ -25,6 +27,11 @@ enum class TokenType {
     END_OF_FILE, UNKNOWN
 };
 
+const char* tokenTypeName(TokenType type);
+
+// Тип слова из букв, цифр и '_': ключевое слово или IDENT.
+TokenType keywordType(std::string_view word);
+
 struct Token {
     TokenType type;
     std::string lexeme;
@@ -40,6 +47,10 @@ class Lexer {
 public:
     Lexer(const std::string& input);
     std::vector<Token> tokenize();
+    // Следующий токен без накопления всего потока; в конце — END_OF_FILE.
+    Token next();
+
+    const LexerStats& stats() const { return statistics; }
 
 private:
     std::string input;
@@ -47,6 +58,7 @@ private:
     size_t length;
     size_t currentLine;
     BoundedDeque<char, LOOKAHEAD_BUFFER_SIZE> lookaheadBuffer;
+    LexerStats statistics;
 
     char currentChar();
     char peekAhead(size_t n = 1);
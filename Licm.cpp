@@ -0,0 +1,217 @@
+#include "Licm.h"
+#include "AstVisitor.h"
+#include "Builtins.h"
+#include "ConstFold.h"
+#include "Resolver.h"
+#include "TypeChecker.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using NodePtr = std::shared_ptr<ASTNode>;
+
+// Ячейки, которые цикл пишет или объявляет.
+class LoopWrites : public AstVisitor<LoopWrites, const ASTNode> {
+public:
+    std::vector<uint8_t> written;
+
+    explicit LoopWrites(size_t frameSize) : written(frameSize, 0) {}
+
+    bool enterAssignment(const ASTNode &node) {
+        mark(node.slot);
+        return false;
+    }
+
+    bool enterVarDecl(const ASTNode &node) {
+        for (size_t i = 0, n = declaredNames(node).size(); i < n; ++i) {
+            mark(node.slot + static_cast<int>(i));
+        }
+        return false;
+    }
+
+    bool enterProcedureCall(const ASTNode &node) {
+        if (node.value == "readln") {
+            for (const auto &arg: node.children) mark(arg->slot);
+        }
+        return false;
+    }
+
+    bool enterExpression(const ASTNode &) { return false; }
+    bool enterTerm(const ASTNode &) { return false; }
+    bool enterFactor(const ASTNode &) { return false; }
+
+private:
+    void mark(int slot) {
+        if (slot >= 0) written[slot] = 1;
+    }
+};
+
+class LoopHoister : public AstRewriter<LoopHoister> {
+public:
+    LoopHoister(size_t frameSize, LicmStats &stats) : frameSize(frameSize), stats(stats) {}
+
+    NodePtr rewriteWhileStatement(const NodePtr &node) {
+        // В списке операторов предзаголовок встаёт перед циклом; иначе цикл
+        // заворачивается в блок, а это спрятало бы объявления тела без
+        // begin/end от кода после цикла — такие циклы не трогаем.
+        ASTNode *enclosing = parent();
+        bool inList = enclosing && enclosing->type == ASTNodeType::StatementBlock;
+        if (!inList && declaresIntoEnclosingBlock(node)) return node;
+
+        LoopWrites writes(frameSize);
+        writes.traverse(*node);
+        written = &writes.written;
+        preheader.clear();
+        temporaries.clear();
+        statement(*node);
+        if (preheader.empty()) return node;
+
+        ++stats.loops;
+        if (inList) {
+            preheaders.emplace(node.get(), std::move(preheader));
+            return node;
+        }
+        auto block = std::make_shared<ASTNode>(ASTNodeType::StatementBlock);
+        for (const auto &decl: preheader) block->addChild(decl);
+        block->addChild(node);
+        return block;
+    }
+
+    NodePtr rewriteStatementBlock(const NodePtr &node) {
+        if (preheaders.empty()) return node;
+        std::vector<NodePtr> children;
+        for (const auto &child: node->children) {
+            auto found = preheaders.find(child.get());
+            if (found != preheaders.end()) {
+                children.insert(children.end(), found->second.begin(), found->second.end());
+                preheaders.erase(found);
+            }
+            children.push_back(child);
+        }
+        node->children = std::move(children);
+        return node;
+    }
+
+private:
+    size_t frameSize;
+    LicmStats &stats;
+    size_t nextTemporary = 0;
+    const std::vector<uint8_t> *written = nullptr;
+    std::vector<NodePtr> preheader;
+    std::unordered_map<const ASTNode *, std::vector<NodePtr>> preheaders;  // цикл -> объявления перед ним
+    std::unordered_map<std::string, std::string> temporaries;  // запись выражения -> имя временной
+
+    void statement(ASTNode &node) {
+        switch (node.type) {
+            case ASTNodeType::StatementBlock:
+                for (const auto &child: node.children) statement(*child);
+                return;
+            case ASTNodeType::Assignment:
+            case ASTNodeType::VarDecl:
+                if (!node.children.empty()) root(node.children[0]);
+                return;
+            case ASTNodeType::IfStatement:
+            case ASTNodeType::WhileStatement:
+                root(node.children[0]);
+                for (size_t i = 1; i < node.children.size(); ++i) statement(*node.children[i]);
+                return;
+            case ASTNodeType::ProcedureCall:
+                if (node.value == "readln") return;
+                for (auto &arg: node.children) root(arg);
+                return;
+            default:
+                return;
+        }
+    }
+
+    void root(NodePtr &expression) {
+        if (invariant(expression)) hoist(expression);
+    }
+
+    // Инвариантно ли подвыражение; вариантное выносит свои наибольшие
+    // инвариантные части.
+    bool invariant(NodePtr &node) {
+        switch (node->type) {
+            case ASTNodeType::Expression:
+            case ASTNodeType::Term: {
+                if (node->children.size() != 2) return false;
+                bool left = invariant(node->children[0]);
+                bool right = invariant(node->children[1]);
+                if (left && right) return true;
+                if (left) hoist(node->children[0]);
+                if (right) hoist(node->children[1]);
+                return false;
+            }
+            case ASTNodeType::Factor:
+                switch (node->factor) {
+                    case FactorKind::Number:
+                        return true;
+                    case FactorKind::Name:
+                        return node->slot >= 0 && !(*written)[node->slot];
+                    case FactorKind::Call:
+                        if (node->slot < 0 || !BUILTINS[node->slot].pure || node->children.size() != 1) return false;
+                        return invariant(node->children[0]);
+                    default:
+                        return false;
+                }
+            default:
+                return false;
+        }
+    }
+
+    // Одиночное имя или литерал выносить незачем.
+    void hoist(NodePtr &node) {
+        if (node->type == ASTNodeType::Factor && node->factor != FactorKind::Call) return;
+        std::string key = spelling(*node);
+        auto found = temporaries.find(key);
+        std::string name;
+        if (found != temporaries.end()) {
+            name = found->second;
+            ++stats.reused;
+        } else {
+            // '$' не встречается в идентификаторах исходника: имя не
+            // совпадёт и не скроет пользовательское.
+            name = "licm$" + std::to_string(nextTemporary++);
+            temporaries.emplace(key, name);
+            // Тип — тип вынесенного выражения: без аннотации временная
+            // стала бы real и не присваивалась бы integer-переменным.
+            auto decl = std::make_shared<ASTNode>(ASTNodeType::VarDecl,
+                                                  name + " : " + valueTypeName(node->valueType));
+            decl->addChild(node);
+            preheader.push_back(decl);
+            ++stats.hoisted;
+        }
+        auto read = std::make_shared<ASTNode>(ASTNodeType::Factor, name);
+        read->factor = FactorKind::Name;
+        read->valueType = node->valueType;
+        node = read;
+    }
+
+    // Запись выражения по ячейкам, а не по именам: одинаковые имена разных
+    // областей не склеиваются.
+    static std::string spelling(const ASTNode &node) {
+        switch (node.factor) {
+            case FactorKind::Number:
+                return formatNumber(node.number);
+            case FactorKind::Name:
+                return "@" + std::to_string(node.slot);
+            case FactorKind::Call:
+                return node.value + "(" + spelling(*node.children[0]) + ")";
+            default:
+                return "(" + spelling(*node.children[0]) + node.value + spelling(*node.children[1]) + ")";
+        }
+    }
+};
+
+}
+
+LicmStats hoistLoopInvariants(std::shared_ptr<ASTNode> &root) {
+    LicmStats stats;
+    Resolution resolution = resolveNames(*root);
+    checkTypes(*root, resolution);
+    LoopHoister hoister(resolution.frameSize, stats);
+    root = hoister.rewrite(root);
+    return stats;
+}
@@ -0,0 +1,30 @@
+#ifndef LICM_H
+#define LICM_H
+
+#include "AST.h"
+#include <cstddef>
+#include <memory>
+
+struct LicmStats {
+    size_t loops = 0;           // циклов, из которых что-то вынесено
+    size_t hoisted = 0;         // вынесенных выражений
+    size_t reused = 0;          // повторов уже вынесенного выражения в том же цикле
+};
+
+// Вынос инвариантов из циклов while. Подвыражение условия или тела
+// инвариантно, если читает только ячейки, которые цикл не пишет и не
+// объявляет, и вызывает только чистые встроенные функции (Builtin::pure).
+// Наибольшие такие подвыражения (не одиночные имена и литералы) вычисляются
+// один раз в предзаголовке — локальных переменных с типом вынесенного
+// выражения, объявленных в списке операторов перед циклом:
+//   while c do x := x + sin(k) * 2   ->   var licm$0 : real := sin(k) * 2; while c do x := x + licm$0
+// Типы берутся из checkTypes, который проход запускает сам.
+// Цикл, стоящий ветвью if или телом while без begin/end, заворачивается
+// вместе с предзаголовком в блок; если его тело без begin/end объявляет
+// переменную, видимую после цикла, такой цикл не обрабатывается.
+// Вычисления в языке не бросают исключений, поэтому вынос из условных
+// ветвей и из цикла, не выполнившегося ни разу, безопасен. Вложенные циклы
+// обрабатываются изнутри наружу, и выражение поднимается на несколько уровней.
+LicmStats hoistLoopInvariants(std::shared_ptr<ASTNode> &root);
+
+#endif
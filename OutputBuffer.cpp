@@ -0,0 +1,104 @@
+#include "OutputBuffer.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Одна попытка записи: число записанных байт или -1 (errno).
+long writeSome(int fd, const char *p, size_t size) {
+#ifdef _WIN32
+    return ::_write(fd, p, static_cast<unsigned>(std::min<size_t>(size, INT_MAX)));
+#else
+    return static_cast<long>(::write(fd, p, size));
+#endif
+}
+
+}
+
+OutputBuffer::OutputBuffer(int fd, size_t capacity) : fd(fd), buffer(capacity < 64 ? 64 : capacity) {}
+
+OutputBuffer::~OutputBuffer() {
+    try {
+        flush();
+    } catch (...) {
+    }
+}
+
+char* OutputBuffer::reserve(size_t n) {
+    if (buffer.size() - size < n) flush();
+    return buffer.data() + size;
+}
+
+void OutputBuffer::append(std::string_view text) {
+    if (text.size() >= buffer.size()) {
+        // Крупный кусок пишем напрямую, не копируя через буфер.
+        flush();
+        writeAll(text.data(), text.size());
+        return;
+    }
+    std::memcpy(reserve(text.size()), text.data(), text.size());
+    size += text.size();
+}
+
+void OutputBuffer::number(double value) {
+    // Знак NaN зависит от порядка операндов в исполнителе, поэтому NaN
+    // пишется всегда одинаково; бесконечности — по знаку.
+    if (std::isnan(value)) {
+        append("nan");
+        return;
+    }
+    if (std::isinf(value)) {
+        append(value < 0 ? "-inf" : "inf");
+        return;
+    }
+    char* p = reserve(32);
+    auto res = std::to_chars(p, p + 32, value);
+    size += static_cast<size_t>(res.ptr - p);
+}
+
+void OutputBuffer::number(uint64_t value) {
+    char* p = reserve(24);
+    auto res = std::to_chars(p, p + 24, value);
+    size += static_cast<size_t>(res.ptr - p);
+}
+
+void OutputBuffer::indent(size_t width) {
+    while (width > 0) {
+        size_t chunk = width < buffer.size() ? width : buffer.size();
+        std::memset(reserve(chunk), ' ', chunk);
+        size += chunk;
+        width -= chunk;
+    }
+}
+
+void OutputBuffer::flush() {
+    if (size == 0) return;
+    TraceSpan span("flush", "output");
+    size_t pending = size;
+    size = 0;
+    writeAll(buffer.data(), pending);
+}
+
+void OutputBuffer::writeAll(const char* p, size_t left) {
+    written += left;
+    while (left > 0) {
+        long n = writeSome(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Ошибка записи вывода");
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Буфер вывода поверх файлового дескриптора: текст копится в одном большом
+// переиспользуемом массиве и сбрасывается крупными вызовами write(2).
+// Числа форматируются через std::to_chars без промежуточных строк.
+class OutputBuffer {
+public:
+    explicit OutputBuffer(int fd = 1, size_t capacity = 1 << 20);
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void put(char c) {
+        if (size == buffer.size()) flush();
+        buffer[size++] = c;
+    }
+
+    void append(std::string_view text);
+    void number(double value);
+    void number(uint64_t value);
+    void indent(size_t width);
+    void flush();
+
+    uint64_t bytesWritten() const { return written + size; }
+
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t size = 0;
+    uint64_t written = 0;
+
+    char* reserve(size_t n);
+    void writeAll(const char* p, size_t n);
+};
+
+#endif
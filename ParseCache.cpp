@@ -0,0 +1,332 @@
+#include "ParseCache.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'S', 'A', 'C', 'A', 'C', 'H', 'E', '\0'};
+const char *CACHE_SUFFIX = ".sac";
+
+uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+class ByteWriter {
+public:
+    std::string data;
+
+    void u8(uint8_t v) { data.push_back(static_cast<char>(v)); }
+
+    void u32(uint32_t v) { raw(&v, sizeof v); }
+
+    void u64(uint64_t v) { raw(&v, sizeof v); }
+
+    void f64(double v) { raw(&v, sizeof v); }
+
+    void str(const std::string &s) {
+        u32(static_cast<uint32_t>(s.size()));
+        data.append(s);
+    }
+
+    void raw(const void *p, size_t n) { data.append(static_cast<const char *>(p), n); }
+};
+
+class ByteReader {
+public:
+    ByteReader(const std::string &data) : data(data) {}
+
+    bool u8(uint8_t &v) { return raw(&v, sizeof v); }
+
+    bool u32(uint32_t &v) { return raw(&v, sizeof v); }
+
+    bool u64(uint64_t &v) { return raw(&v, sizeof v); }
+
+    bool f64(double &v) { return raw(&v, sizeof v); }
+
+    bool str(std::string &s) {
+        uint32_t n;
+        if (!u32(n) || data.size() - pos < n) return false;
+        s.assign(data, pos, n);
+        pos += n;
+        return true;
+    }
+
+    bool raw(void *p, size_t n) {
+        if (data.size() - pos < n) return false;
+        std::memcpy(p, data.data() + pos, n);
+        pos += n;
+        return true;
+    }
+
+    bool atEnd() const { return pos == data.size(); }
+
+private:
+    const std::string &data;
+    size_t pos = 0;
+};
+
+void writeTree(ByteWriter &out, const std::shared_ptr<ASTNode> &root) {
+    std::vector<const ASTNode *> stack{root.get()};
+    while (!stack.empty()) {
+        const ASTNode *node = stack.back();
+        stack.pop_back();
+        out.u8(static_cast<uint8_t>(node->type));
+        out.str(node->value);
+        out.u8(static_cast<uint8_t>(node->factor));
+        out.f64(node->number);
+        out.u32(static_cast<uint32_t>(node->children.size()));
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
+            stack.push_back(it->get());
+        }
+    }
+}
+
+bool readTree(ByteReader &in, std::shared_ptr<ASTNode> &root) {
+    // Узел и число ещё не прочитанных детей.
+    std::vector<std::pair<ASTNode *, uint32_t>> stack;
+    do {
+        uint8_t type, factor;
+        std::string value;
+        double number;
+        uint32_t childCount;
+        if (!in.u8(type) || type > static_cast<uint8_t>(ASTNodeType::END)) return false;
+        if (!in.str(value) || !in.u8(factor) || factor > static_cast<uint8_t>(FactorKind::Call)) return false;
+        if (!in.f64(number) || !in.u32(childCount)) return false;
+        auto node = std::make_shared<ASTNode>(static_cast<ASTNodeType>(type), std::move(value));
+        node->factor = static_cast<FactorKind>(factor);
+        node->number = number;
+        if (stack.empty()) {
+            root = node;
+        } else {
+            stack.back().first->addChild(node);
+            --stack.back().second;
+        }
+        if (childCount > 0) {
+            node->children.reserve(childCount);
+            stack.emplace_back(node.get(), childCount);
+        }
+        while (!stack.empty() && stack.back().second == 0) {
+            stack.pop_back();
+        }
+    } while (!stack.empty());
+    return true;
+}
+
+bool readFile(const std::string &path, std::string &data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    data = buffer.str();
+    return true;
+}
+
+}
+
+ParseCache::ParseCache(std::string directory, uint64_t limitBytes)
+        : directory(std::move(directory)), limitBytes(limitBytes) {
+    std::error_code ec;
+    fs::create_directories(this->directory, ec);
+    if (ec) {
+        throw std::runtime_error("Не удалось создать каталог кэша: " + this->directory);
+    }
+}
+
+uint64_t ParseCache::hashBytes(const char *data, size_t size, uint64_t seed) {
+    uint64_t h = seed ^ (size * 0x9e3779b97f4a7c15ULL);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof word);
+        h = rotl(h ^ mix(word), 27) * 0x9e3779b97f4a7c15ULL + 0x52dce729;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data + i, size - i);
+    return mix(h ^ mix(tail ^ (size - i)));
+}
+
+uint64_t ParseCache::makeKey(const std::string &source, uint32_t grammarFlags) {
+    uint64_t seed = hashBytes(ANALYZER_VERSION, std::strlen(ANALYZER_VERSION), PARSE_CACHE_FORMAT);
+    seed = mix(seed ^ grammarFlags);
+    return hashBytes(source.data(), source.size(), seed);
+}
+
+std::string ParseCache::entryPath(uint64_t key) const {
+    char name[17];
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 15; i >= 0; --i) {
+        name[i] = digits[key & 0xf];
+        key >>= 4;
+    }
+    name[16] = '\0';
+    return (fs::path(directory) / (std::string(name) + CACHE_SUFFIX)).string();
+}
+
+bool ParseCache::load(uint64_t key, const std::string &source,
+                      std::vector<Token> &tokens, std::shared_ptr<ASTNode> &ast) {
+    std::string path = entryPath(key);
+    std::string data;
+    if (!readFile(path, data)) {
+        ++missCount;
+        return false;
+    }
+
+    ByteReader in(data);
+    char magic[sizeof CACHE_MAGIC];
+    uint32_t format;
+    uint64_t storedKey, sourceSize, sourceCheck, tokenCount;
+    bool ok = in.raw(magic, sizeof magic) && std::memcmp(magic, CACHE_MAGIC, sizeof magic) == 0 &&
+              in.u32(format) && format == PARSE_CACHE_FORMAT &&
+              in.u64(storedKey) && storedKey == key &&
+              in.u64(sourceSize) && sourceSize == source.size() &&
+              in.u64(sourceCheck) && sourceCheck == hashBytes(source.data(), source.size(), ~key) &&
+              in.u64(tokenCount) && tokenCount <= data.size();
+
+    std::vector<Token> loadedTokens;
+    if (ok) {
+        loadedTokens.reserve(tokenCount);
+        for (uint64_t i = 0; i < tokenCount && ok; ++i) {
+            uint8_t type;
+            uint64_t line;
+            double value;
+            std::string lexeme;
+            ok = in.u8(type) && type <= static_cast<uint8_t>(TokenType::UNKNOWN) &&
+                 in.u64(line) && in.f64(value) && in.str(lexeme);
+            if (ok) {
+                loadedTokens.emplace_back(static_cast<TokenType>(type), lexeme, value, line);
+            }
+        }
+    }
+    std::shared_ptr<ASTNode> loadedAst;
+    ok = ok && readTree(in, loadedAst) && in.atEnd();
+
+    if (!ok) {
+        // Повреждённая или чужая запись: считаем промахом и убираем её.
+        std::error_code ec;
+        fs::remove(path, ec);
+        ++missCount;
+        return false;
+    }
+
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    tokens = std::move(loadedTokens);
+    ast = std::move(loadedAst);
+    ++hitCount;
+    return true;
+}
+
+void ParseCache::store(uint64_t key, const std::string &source,
+                       const std::vector<Token> &tokens, const std::shared_ptr<ASTNode> &ast) {
+    ByteWriter out;
+    out.raw(CACHE_MAGIC, sizeof CACHE_MAGIC);
+    out.u32(PARSE_CACHE_FORMAT);
+    out.u64(key);
+    out.u64(source.size());
+    out.u64(hashBytes(source.data(), source.size(), ~key));
+    out.u64(tokens.size());
+    for (const auto &token: tokens) {
+        out.u8(static_cast<uint8_t>(token.type));
+        out.u64(token.line);
+        out.f64(token.value);
+        out.str(token.lexeme);
+    }
+    writeTree(out, ast);
+
+    // Случайная метка процесса вместо pid (переносимо): временные файлы разных
+    // процессов не совпадают, внутри процесса их различает счётчик.
+    static const uint64_t processTag =
+            (static_cast<uint64_t>(std::random_device{}()) << 32) ^
+            static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    static std::atomic<uint64_t> sequence{0};
+    std::string path = entryPath(key);
+    std::string tmpPath = path + ".tmp." + std::to_string(processTag) + "." +
+                          std::to_string(sequence.fetch_add(1));
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file) return;
+        file.write(out.data.data(), static_cast<std::streamsize>(out.data.size()));
+        if (!file) {
+            file.close();
+            std::error_code ec;
+            fs::remove(tmpPath, ec);
+            return;
+        }
+    }
+
+    // rename атомарен в пределах одной файловой системы: читатели видят либо
+    // старую запись целиком, либо новую.
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        fs::remove(tmpPath, ec);
+        return;
+    }
+
+    if (storesSinceEvict.fetch_add(1) + 1 >= 64) {
+        evict();
+    }
+}
+
+void ParseCache::evict() {
+    storesSinceEvict = 0;
+
+    struct Entry {
+        fs::path path;
+        fs::file_time_type time;
+        uint64_t size;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    auto staleBefore = fs::file_time_type::clock::now() - std::chrono::hours(1);
+
+    std::error_code ec;
+    for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code entryEc;
+        if (!it->is_regular_file(entryEc)) continue;
+        const fs::path &path = it->path();
+        auto time = it->last_write_time(entryEc);
+        uint64_t size = it->file_size(entryEc);
+        if (entryEc) continue;
+
+        std::string name = path.filename().string();
+        if (name.find(".tmp.") != std::string::npos) {
+            // Осиротевшие временные файлы упавших процессов.
+            if (time < staleBefore) fs::remove(path, entryEc);
+            continue;
+        }
+        if (path.extension() != CACHE_SUFFIX) continue;
+        entries.push_back({path, time, size});
+        total += size;
+    }
+    if (total <= limitBytes) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.time < b.time;
+    });
+    for (const auto &entry: entries) {
+        if (total <= limitBytes) break;
+        std::error_code removeEc;
+        // Запись могла уже удалить другая копия анализатора — это не ошибка.
+        fs::remove(entry.path, removeEc);
+        total -= entry.size;
+    }
+}
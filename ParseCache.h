@@ -0,0 +1,49 @@
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include "AST.h"
+#include "Lexer.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Версия анализатора входит в ключ кэша: любое изменение лексера, парсера
+// или формата AST должно сопровождаться её увеличением.
+constexpr const char *ANALYZER_VERSION = "syntax-analyzer 1.4";
+constexpr uint32_t PARSE_CACHE_FORMAT = 2;
+
+// Постоянный кэш результатов разбора на диске. Ключ — быстрый хэш байтов
+// исходника, версии анализатора и флагов грамматики. Записи пишутся во
+// временный файл и атомарно переименовываются, поэтому несколько процессов
+// могут безопасно работать с одним каталогом. Вытеснение — LRU по размеру:
+// время модификации файла обновляется при каждом попадании.
+class ParseCache {
+public:
+    ParseCache(std::string directory, uint64_t limitBytes);
+
+    static uint64_t hashBytes(const char *data, size_t size, uint64_t seed);
+    static uint64_t makeKey(const std::string &source, uint32_t grammarFlags);
+
+    bool load(uint64_t key, const std::string &source,
+              std::vector<Token> &tokens, std::shared_ptr<ASTNode> &ast);
+    void store(uint64_t key, const std::string &source,
+               const std::vector<Token> &tokens, const std::shared_ptr<ASTNode> &ast);
+    void evict();
+
+    size_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+    size_t misses() const { return missCount.load(std::memory_order_relaxed); }
+
+private:
+    std::string directory;
+    uint64_t limitBytes;
+    // Один кэш может обслуживать параллельные разборы.
+    std::atomic<size_t> hitCount{0};
+    std::atomic<size_t> missCount{0};
+    std::atomic<size_t> storesSinceEvict{0};
+
+    std::string entryPath(uint64_t key) const;
+};
+
+#endif
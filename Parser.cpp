@@ -1,15 +1,72 @@
 #include "Parser.h"
+#include "AllocProfile.h"
+#include "RuleProfile.h"
+#include <algorithm>
 #include <sstream>
 
+#ifdef ANALYZER_STATS
+namespace {
+
+// Вложенность parseStatement и parseExpression — через них проходит любая
+// рекурсия грамматики.
+class DepthGuard {
+public:
+    DepthGuard(size_t &depth, ParserStats &stats) : depth(depth) {
+        stats.maxDepth = std::max(stats.maxDepth, ++depth);
+    }
+
+    ~DepthGuard() {
+        --depth;
+    }
+
+private:
+    size_t &depth;
+};
+
+}
+#endif
 
 Parser::Parser(const std::vector<Token> &tokens) : tokens(tokens), current(0) {}
 
+std::shared_ptr<ASTNode> Parser::makeNode(ASTNodeType type, std::string value) {
+#ifdef ANALYZER_STATS
+    ++statistics.nodes;
+    allocNodeType = static_cast<int>(type);
+    auto node = std::make_shared<ASTNode>(type, std::move(value));
+    allocNodeType = -1;
+    return node;
+#else
+    return std::make_shared<ASTNode>(type, std::move(value));
+#endif
+}
+
+void Parser::lookahead(size_t distance) {
+    STATS(statistics.peakLookahead = std::max(statistics.peakLookahead, distance);)
+    RULE_PEEK(distance);
+    (void) distance;
+}
+
 Token Parser::currentToken() {
+    RULE_PEEK(0);
     if (current < tokens.size())
         return tokens[current];
     return Token(TokenType::END_OF_FILE, "");
 }
 
+// var a, b [: тип] := ... — локальное объявление с инициализатором.
+bool Parser::isLocalVarDecl() {
+    size_t i = current + 1;
+    auto at = [&](TokenType type) { return i < tokens.size() && tokens[i].type == type; };
+    if (!at(TokenType::IDENT)) return false;
+    ++i;
+    while (at(TokenType::COMMA)) {
+        i += 2;
+    }
+    if (at(TokenType::COLON)) i += 2;
+    lookahead(i - current);
+    return at(TokenType::ASSIGN);
+}
+
 Token Parser::consume(TokenType expected, const std::string &errorMessage) {
     if (currentToken().type == expected) {
         return tokens[current++];
@@ -34,24 +91,38 @@ bool Parser::match(TokenType type) {
 }
 
 std::shared_ptr<ASTNode> Parser::parse() {
+#ifdef ANALYZER_STATS
+    try {
+        auto program = parseProgram();
+        statistics.tokens = current;
+        return program;
+    } catch (...) {
+        ++statistics.errors;
+        statistics.tokens = current;
+        throw;
+    }
+#else
     return parseProgram();
+#endif
 }
 
 std::shared_ptr<ASTNode> Parser::parseProgram() {
-    auto node = std::make_shared<ASTNode>(ASTNodeType::Program);
+    RULE(Program);
+    auto node = makeNode(ASTNodeType::Program);
     node->addChild(parseBlock());
     consume(TokenType::DOT, "Ожидалась точка ('.') в конце программы.");
     return node;
 }
 
 std::shared_ptr<ASTNode> Parser::parseBlock() {
-    auto node = std::make_shared<ASTNode>(ASTNodeType::Block);
+    RULE(Block);
+    auto node = makeNode(ASTNodeType::Block);
     if (currentToken().type == TokenType::CONST) {
         node->addChild(parseConstDecl());
     }
     if (currentToken().type == TokenType::VAR) {
 
-        if (tokens[current + 1].type != TokenType::IDENT || tokens[current + 2].type != TokenType::ASSIGN)
+        if (!isLocalVarDecl())
             node->addChild(parseVarDecl());
         else
             node->addChild(parseLocalVarDecl());
@@ -65,23 +136,29 @@ std::shared_ptr<ASTNode> Parser::parseBlock() {
 
 
 std::shared_ptr<ASTNode> Parser::parseConstDecl() {
+    RULE(ConstDecl);
     consume(TokenType::CONST, "Ожидалось 'const'");
-    auto node = std::make_shared<ASTNode>(ASTNodeType::ConstDecl);
+    auto node = makeNode(ASTNodeType::ConstDecl);
     do {
         Token id = consume(TokenType::IDENT, "Ожидался идентификатор в объявлении константы.");
         consume(TokenType::EQ, "Ожидался '=' в объявлении константы.");
         Token num = consume(TokenType::NUMBER, "Ожидалось число в объявлении константы.");
         consume(TokenType::SEMI, "Ожидалась ';' после объявления константы.");
-        auto constNode = std::make_shared<ASTNode>(ASTNodeType::ConstDecl,
+        auto constNode = makeNode(ASTNodeType::ConstDecl,
                                                    id.lexeme + " = " + std::to_string(num.value));
+        auto valueNode = makeNode(ASTNodeType::Factor, num.lexeme);
+        valueNode->factor = FactorKind::Number;
+        valueNode->number = num.value;
+        constNode->addChild(valueNode);
         node->addChild(constNode);
     } while (currentToken().type == TokenType::IDENT);
     return node;
 }
 
 std::shared_ptr<ASTNode> Parser::parseVarDecl() {
+    RULE(VarDecl);
     consume(TokenType::VAR, "Ожидалось 'var'");
-    auto node = std::make_shared<ASTNode>(ASTNodeType::VarDecl);
+    auto node = makeNode(ASTNodeType::VarDecl);
     Token id = consume(TokenType::IDENT, "Ожидался идентификатор в объявлении переменной.");
     node->value += id.lexeme;
     while (currentToken().type == TokenType::COMMA) {
@@ -100,8 +177,9 @@ std::shared_ptr<ASTNode> Parser::parseVarDecl() {
 }
 
 std::shared_ptr<ASTNode> Parser::parseLocalVarDecl() {
+    RULE(LocalVarDecl);
     consume(TokenType::VAR, "Ожидалось 'var' для локальной переменной");
-    auto node = std::make_shared<ASTNode>(ASTNodeType::VarDecl);
+    auto node = makeNode(ASTNodeType::VarDecl);
     Token id = consume(TokenType::IDENT, "Ожидался идентификатор локальной переменной.");
     node->value += id.lexeme;
     while (currentToken().type == TokenType::COMMA) {
@@ -122,18 +200,20 @@ std::shared_ptr<ASTNode> Parser::parseLocalVarDecl() {
 }
 
 std::shared_ptr<ASTNode> Parser::parseTemplateDecl() {
+    RULE(TemplateDecl);
     consume(TokenType::TEMPLATE, "Ожидалось 'template'");
     consume(TokenType::LT, "Ожидался символ '<' после 'template'");
     consume(TokenType::TYPENAME, "Ожидалось 'typename' в шаблоне");
     Token param = consume(TokenType::IDENT, "Ожидался идентификатор параметра шаблона");
     consume(TokenType::GT, "Ожидался символ '>' после параметра шаблона");
-    auto node = std::make_shared<ASTNode>(ASTNodeType::TemplateDecl, param.lexeme);
+    auto node = makeNode(ASTNodeType::TemplateDecl, param.lexeme);
     return node;
 }
 
 std::shared_ptr<ASTNode> Parser::parseStatementBlock() {
+    RULE(StatementBlock);
     consume(TokenType::BEGIN, "Ожидалось 'begin'");
-    auto node = std::make_shared<ASTNode>(ASTNodeType::StatementBlock);
+    auto node = makeNode(ASTNodeType::StatementBlock);
     while (currentToken().type != TokenType::END) {
         node->addChild(parseStatement());
     }
@@ -142,17 +222,19 @@ std::shared_ptr<ASTNode> Parser::parseStatementBlock() {
 }
 
 std::shared_ptr<ASTNode> Parser::parseStatement() {
+    RULE(Statement);
+    STATS(DepthGuard guard(depth, statistics);)
     TokenType t = currentToken().type;
 
     if (t == TokenType::SEMI) {
         consume(TokenType::SEMI, "");
-        return std::make_shared<ASTNode>(ASTNodeType::Unknown, "EmptyStatement");
+        return makeNode(ASTNodeType::Unknown, "EmptyStatement");
     }
 
     if (t == TokenType::BEGIN) {
         return parseStatementBlock();
     } else if (t == TokenType::VAR) {
-        if (tokens[current + 1].type == TokenType::IDENT && tokens[current + 2].type == TokenType::ASSIGN)
+        if (isLocalVarDecl())
             return parseLocalVarDecl();
         else
             return parseVarDecl();
@@ -164,6 +246,7 @@ std::shared_ptr<ASTNode> Parser::parseStatement() {
                t == TokenType::READLN || t == TokenType::ASSERT) {
         return parseProcedureCall();
     } else if (t == TokenType::IDENT) {
+        lookahead(1);
         if (tokens[current + 1].type == TokenType::ASSIGN)
             return parseAssignment();
         else
@@ -174,21 +257,23 @@ std::shared_ptr<ASTNode> Parser::parseStatement() {
 }
 
 std::shared_ptr<ASTNode> Parser::parseAssignment() {
+    RULE(Assignment);
     Token id = consume(TokenType::IDENT, "Ожидался идентификатор в операторе присваивания");
     consume(TokenType::ASSIGN, "Ожидалось ':=' в операторе присваивания");
     auto exprNode = parseExpression();
     consume(TokenType::SEMI, "Ожидалась ';' после оператора присваивания");
-    auto node = std::make_shared<ASTNode>(ASTNodeType::Assignment, id.lexeme);
+    auto node = makeNode(ASTNodeType::Assignment, id.lexeme);
     node->addChild(exprNode);
     return node;
 }
 
 std::shared_ptr<ASTNode> Parser::parseIfStatement() {
+    RULE(IfStatement);
     consume(TokenType::IF, "Ожидалось 'if'");
     auto exprNode = parseExpression();
     consume(TokenType::THEN, "Ожидалось 'then' в операторе if");
     auto thenStmt = parseStatement();
-    auto ifNode = std::make_shared<ASTNode>(ASTNodeType::IfStatement);
+    auto ifNode = makeNode(ASTNodeType::IfStatement);
     ifNode->addChild(exprNode);
     ifNode->addChild(thenStmt);
     if (currentToken().type == TokenType::ELSE) {
@@ -200,22 +285,25 @@ std::shared_ptr<ASTNode> Parser::parseIfStatement() {
 }
 
 std::shared_ptr<ASTNode> Parser::parseWhileStatement() {
+    RULE(WhileStatement);
     consume(TokenType::WHILE, "Ожидалось 'while'");
     auto exprNode = parseExpression();
     consume(TokenType::DO, "Ожидалось 'do' в цикле while");
     auto stmt = parseStatement();
-    auto node = std::make_shared<ASTNode>(ASTNodeType::WhileStatement);
+    auto node = makeNode(ASTNodeType::WhileStatement);
     node->addChild(exprNode);
     node->addChild(stmt);
     return node;
 }
 
 std::shared_ptr<ASTNode> Parser::parseProcedureCall() {
+    RULE(ProcedureCall);
     Token proc = consume(currentToken().type, "Ожидался идентификатор или ключевое слово процедуры");
+    auto node = makeNode(ASTNodeType::ProcedureCall, proc.lexeme);
     consume(TokenType::LPAREN, "Ожидалось '(' в вызове процедуры");
     // Разбираем аргументы вызова (используем полное выражение, включающее реляционные операторы)
     while (currentToken().type != TokenType::RPAREN) {
-        parseExpression();
+        node->addChild(parseExpression());
         if (currentToken().type == TokenType::COMMA)
             consume(TokenType::COMMA, "Ожидалась ',' между аргументами");
         else
@@ -223,11 +311,12 @@ std::shared_ptr<ASTNode> Parser::parseProcedureCall() {
     }
     consume(TokenType::RPAREN, "Ожидалось ')' в вызове процедуры");
     consume(TokenType::SEMI, "Ожидалась ';' после вызова процедуры");
-    auto node = std::make_shared<ASTNode>(ASTNodeType::ProcedureCall, proc.lexeme);
     return node;
 }
 
 std::shared_ptr<ASTNode> Parser::parseExpression() {
+    RULE(Expression);
+    STATS(DepthGuard guard(depth, statistics);)
     auto node = parseAdditive();
     while (currentToken().type == TokenType::LT ||
            currentToken().type == TokenType::GT ||
@@ -238,7 +327,7 @@ std::shared_ptr<ASTNode> Parser::parseExpression() {
         Token op = currentToken();
         consume(op.type, "Ожидался оператор сравнения");
         auto right = parseAdditive();
-        auto cmpNode = std::make_shared<ASTNode>(ASTNodeType::Expression, op.lexeme);
+        auto cmpNode = makeNode(ASTNodeType::Expression, op.lexeme);
         cmpNode->addChild(node);
         cmpNode->addChild(right);
         node = cmpNode;
@@ -247,12 +336,13 @@ std::shared_ptr<ASTNode> Parser::parseExpression() {
 }
 
 std::shared_ptr<ASTNode> Parser::parseAdditive() {
+    RULE(Additive);
     auto node = parseTerm();
     while (currentToken().type == TokenType::PLUS || currentToken().type == TokenType::MINUS) {
         Token op = currentToken();
         consume(op.type, "Ожидался оператор '+' или '-'");
         auto right = parseTerm();
-        auto exprNode = std::make_shared<ASTNode>(ASTNodeType::Expression, op.lexeme);
+        auto exprNode = makeNode(ASTNodeType::Expression, op.lexeme);
         exprNode->addChild(node);
         exprNode->addChild(right);
         node = exprNode;
@@ -261,12 +351,13 @@ std::shared_ptr<ASTNode> Parser::parseAdditive() {
 }
 
 std::shared_ptr<ASTNode> Parser::parseTerm() {
+    RULE(Term);
     auto node = parseFactor();
     while (currentToken().type == TokenType::TIMES || currentToken().type == TokenType::DIVIDE) {
         Token op = currentToken();
         consume(op.type, "Ожидался оператор '*' или '/'");
         auto right = parseFactor();
-        auto termNode = std::make_shared<ASTNode>(ASTNodeType::Term, op.lexeme);
+        auto termNode = makeNode(ASTNodeType::Term, op.lexeme);
         termNode->addChild(node);
         termNode->addChild(right);
         node = termNode;
@@ -275,18 +366,25 @@ std::shared_ptr<ASTNode> Parser::parseTerm() {
 }
 
 std::shared_ptr<ASTNode> Parser::parseFactor() {
+    RULE(Factor);
     Token token = currentToken();
     if (token.type == TokenType::NUMBER) {
         consume(TokenType::NUMBER, "Ожидалось число");
-        return std::make_shared<ASTNode>(ASTNodeType::Factor, token.lexeme);
+        auto node = makeNode(ASTNodeType::Factor, token.lexeme);
+        node->factor = FactorKind::Number;
+        node->number = token.value;
+        return node;
     } else if (token.type == TokenType::STRING_LITERAL) {
         consume(TokenType::STRING_LITERAL, "Ожидался строковый литерал");
-        return std::make_shared<ASTNode>(ASTNodeType::Factor, token.lexeme);
+        auto node = makeNode(ASTNodeType::Factor, token.lexeme);
+        node->factor = FactorKind::String;
+        return node;
     } else if (token.type == TokenType::IDENT) {
         consume(TokenType::IDENT, "Ожидался идентификатор");
         // Если после идентификатора идёт открывающая скобка – это вызов функции
         if (currentToken().type == TokenType::LPAREN) {
-            auto funcNode = std::make_shared<ASTNode>(ASTNodeType::Factor, token.lexeme);
+            auto funcNode = makeNode(ASTNodeType::Factor, token.lexeme);
+            funcNode->factor = FactorKind::Call;
             consume(TokenType::LPAREN, "Ожидалось '(' после идентификатора");
             while (currentToken().type != TokenType::RPAREN) {
                 auto arg = parseExpression();
@@ -299,7 +397,9 @@ std::shared_ptr<ASTNode> Parser::parseFactor() {
             consume(TokenType::RPAREN, "Ожидалось ')' в вызове функции");
             return funcNode;
         }
-        return std::make_shared<ASTNode>(ASTNodeType::Factor, token.lexeme);
+        auto node = makeNode(ASTNodeType::Factor, token.lexeme);
+        node->factor = FactorKind::Name;
+        return node;
     } else if (token.type == TokenType::LPAREN) {
         consume(TokenType::LPAREN, "Ожидалось '('");
         auto node = parseExpression();
@@ -6,19 +6,27 @@
 #include <memory>
 #include <string>
 #include "Lexer.h"
+#include "Stats.h"
 
 class Parser {
 public:
     Parser(const std::vector<Token>& tokens);
     std::shared_ptr<ASTNode> parse();
 
+    const ParserStats& stats() const { return statistics; }
+
 private:
     std::vector<Token> tokens;
     size_t current;
+    ParserStats statistics;
+    size_t depth = 0;
 
     Token currentToken();
     Token consume(TokenType expected, const std::string& errorMessage);
     bool match(TokenType type);
+    bool isLocalVarDecl();
+    std::shared_ptr<ASTNode> makeNode(ASTNodeType type, std::string value = "");
+    void lookahead(size_t distance);
 
     std::shared_ptr<ASTNode> parseProgram();
     std::shared_ptr<ASTNode> parseBlock();
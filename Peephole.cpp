@@ -0,0 +1,113 @@
+#include "Peephole.h"
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Match {
+    Instruction fused;
+    size_t length;      // 1 — слияния нет
+};
+
+class Fuser {
+public:
+    Fuser(const std::vector<Instruction> &code, const std::vector<bool> &isTarget)
+            : code(code), isTarget(isTarget) {}
+
+    Match match(size_t i) const {
+        const Instruction &first = code[i];
+        switch (first.op) {
+            case OpCode::Load:
+                if (is(i, 1, OpCode::PushConst) && is(i, 2, OpCode::Add) && is(i, 3, OpCode::Store) &&
+                    code[i + 3].a == first.a) {
+                    return {{OpCode::IncSlot, first.a, code[i + 1].a}, 4};
+                }
+                if (is(i, 1, OpCode::Load)) {
+                    OpCode op = OpCode::LoadLoad;
+                    if (is(i, 2, OpCode::Add)) op = OpCode::LoadLoadAdd;
+                    else if (is(i, 2, OpCode::Sub)) op = OpCode::LoadLoadSub;
+                    else if (is(i, 2, OpCode::Mul)) op = OpCode::LoadLoadMul;
+                    return {{op, first.a, code[i + 1].a}, op == OpCode::LoadLoad ? size_t(2) : size_t(3)};
+                }
+                if (is(i, 1, OpCode::Store)) {
+                    return {{OpCode::Move, first.a, code[i + 1].a}, 2};
+                }
+                break;
+            case OpCode::PushConst:
+                if (is(i, 1, OpCode::Add)) return {{OpCode::AddConst, first.a}, 2};
+                if (is(i, 1, OpCode::Sub)) return {{OpCode::SubConst, first.a}, 2};
+                if (is(i, 1, OpCode::Mul)) return {{OpCode::MulConst, first.a}, 2};
+                if (is(i, 1, OpCode::Div)) return {{OpCode::DivConst, first.a}, 2};
+                break;
+            case OpCode::Store:
+                // Не отнимаем LOAD у более длинного окна, которое с него начинается.
+                if (is(i, 1, OpCode::Load) && match(i + 1).length == 1) {
+                    return {{OpCode::StoreLoad, first.a, code[i + 1].a}, 2};
+                }
+                break;
+            case OpCode::Lt:
+            case OpCode::Gt:
+            case OpCode::Le:
+            case OpCode::Ge:
+            case OpCode::Eq:
+            case OpCode::Ne: {
+                auto comparison = static_cast<uint32_t>(first.op) - static_cast<uint32_t>(OpCode::Add);
+                if (is(i, 1, OpCode::JumpIfFalse)) return {{OpCode::CmpJumpIfFalse, code[i + 1].a, comparison}, 2};
+                if (is(i, 1, OpCode::JumpIfTrue)) return {{OpCode::CmpJumpIfTrue, code[i + 1].a, comparison}, 2};
+                break;
+            }
+            default:
+                break;
+        }
+        return {first, 1};
+    }
+
+private:
+    const std::vector<Instruction> &code;
+    const std::vector<bool> &isTarget;
+
+    // Команда i + offset имеет код op и на неё не ведут переходы, то есть
+    // окно можно слить.
+    bool is(size_t i, size_t offset, OpCode op) const {
+        size_t k = i + offset;
+        if (k >= code.size() || code[k].op != op) return false;
+        for (size_t j = i + 1; j <= k; ++j) {
+            if (isTarget[j]) return false;
+        }
+        return true;
+    }
+};
+
+}
+
+size_t fuseSuperinstructions(Chunk &chunk) {
+    std::vector<Instruction> &code = chunk.code;
+    std::vector<bool> isTarget(code.size() + 1, false);
+    for (const auto &ins: code) {
+        if (isJump(ins.op)) isTarget[ins.a] = true;
+    }
+    if (chunk.loopBody < code.size()) isTarget[chunk.loopBody] = true;
+
+    Fuser fuser(code, isTarget);
+    std::vector<Instruction> fused;
+    fused.reserve(code.size());
+    std::vector<uint32_t> newIndex(code.size() + 1);
+    for (size_t i = 0; i < code.size();) {
+        Match m = fuser.match(i);
+        for (size_t k = 0; k < m.length; ++k) {
+            newIndex[i + k] = static_cast<uint32_t>(fused.size());
+        }
+        fused.push_back(m.fused);
+        i += m.length;
+    }
+    newIndex[code.size()] = static_cast<uint32_t>(fused.size());
+
+    for (auto &ins: fused) {
+        if (isJump(ins.op)) ins.a = newIndex[ins.a];
+    }
+    if (chunk.loopBody != UINT32_MAX) chunk.loopBody = newIndex[chunk.loopBody];
+
+    size_t removed = code.size() - fused.size();
+    code = std::move(fused);
+    return removed;
+}
@@ -0,0 +1,20 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include "Bytecode.h"
+#include <cstddef>
+
+// Оконная оптимизация байткода: частые последовательности команд сливаются в
+// суперинструкции, чтобы на операцию исходного кода приходилось меньше
+// диспетчеризаций. Набор выбран по профилю пар команд (engine_bench --pairs):
+//   LOAD LOAD [ADD|SUB|MUL]          -> LOAD_LOAD[_ADD|_SUB|_MUL]
+//   LOAD a PUSH_CONST c ADD STORE a  -> INC_SLOT
+//   LOAD STORE                       -> MOVE
+//   STORE LOAD                       -> STORE_LOAD
+//   PUSH_CONST ADD|SUB|MUL|DIV       -> ADD_CONST ... DIV_CONST
+//   LT..NE JUMP_IF_FALSE|TRUE        -> CMP_JUMP_IF_FALSE|TRUE
+// Внутрь окна не должен вести ни один переход; адреса переходов и loopBody
+// пересчитываются. Возвращает число исключённых команд.
+size_t fuseSuperinstructions(Chunk &chunk);
+
+#endif
@@ -0,0 +1,134 @@
+#include "PerfCounters.h"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+thread_local std::unique_ptr<PerfCounters> counters;
+
+#ifdef __linux__
+struct EventConfig {
+    uint32_t type;
+    uint64_t config;
+};
+
+const EventConfig EVENTS[] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+int openEvent(const EventConfig &event) {
+    perf_event_attr attr{};
+    attr.size = sizeof attr;
+    attr.type = event.type;
+    attr.config = event.config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+}
+
+const char *hardwareEventName(HardwareEvent event) {
+    switch (event) {
+        case HardwareEvent::Cycles: return "cycles";
+        case HardwareEvent::Instructions: return "instructions";
+        case HardwareEvent::L1dMisses: return "l1d_misses";
+        case HardwareEvent::LlcMisses: return "llc_misses";
+        case HardwareEvent::BranchMisses: return "branch_misses";
+        case HardwareEvent::PageFaults: return "page_faults";
+        case HardwareEvent::Count: break;
+    }
+    return "unknown";
+}
+
+double HardwareCounters::ipc() const {
+    if (!has(HardwareEvent::Cycles) || !has(HardwareEvent::Instructions) || !(*this)[HardwareEvent::Cycles]) {
+        return NAN;
+    }
+    return static_cast<double>((*this)[HardwareEvent::Instructions]) /
+           static_cast<double>((*this)[HardwareEvent::Cycles]);
+}
+
+HardwareCounters& HardwareCounters::operator+=(const HardwareCounters& other) {
+    for (size_t i = 0; i < static_cast<size_t>(HardwareEvent::Count); ++i) values[i] += other.values[i];
+    valid |= other.valid;
+    return *this;
+}
+
+HardwareCounters operator-(const HardwareCounters& after, const HardwareCounters& before) {
+    HardwareCounters result;
+    result.valid = after.valid & before.valid;
+    for (size_t i = 0; i < static_cast<size_t>(HardwareEvent::Count); ++i) {
+        result.values[i] = after.values[i] >= before.values[i] ? after.values[i] - before.values[i] : 0;
+    }
+    return result;
+}
+
+PerfCounters::PerfCounters() {
+    std::memset(fds, -1, sizeof fds);
+#ifdef __linux__
+    for (size_t i = 0; i < static_cast<size_t>(HardwareEvent::Count); ++i) {
+        fds[i] = openEvent(EVENTS[i]);
+        if (fds[i] >= 0) {
+            mask |= 1u << i;
+        } else {
+            if (!reason.empty()) reason += ", ";
+            reason += std::string(hardwareEventName(static_cast<HardwareEvent>(i))) + ": " + std::strerror(errno);
+        }
+    }
+#else
+    reason = "perf_event_open есть только в Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd: fds) {
+        if (fd >= 0) close(fd);
+    }
+#endif
+}
+
+HardwareCounters PerfCounters::read() const {
+    HardwareCounters result;
+#ifdef __linux__
+    for (size_t i = 0; i < static_cast<size_t>(HardwareEvent::Count); ++i) {
+        if (fds[i] < 0) continue;
+        // value, time_enabled, time_running: при мультиплексировании счётчик
+        // работал часть времени, показание масштабируется на всё время.
+        uint64_t data[3];
+        if (::read(fds[i], data, sizeof data) != sizeof data) continue;
+        double scale = data[2] ? static_cast<double>(data[1]) / static_cast<double>(data[2]) : 0;
+        result.values[i] = static_cast<uint64_t>(static_cast<double>(data[0]) * scale);
+        result.valid |= 1u << i;
+    }
+#endif
+    return result;
+}
+
+void enablePerfCounters(bool enabled) {
+    if (!enabled) {
+        counters.reset();
+    } else if (!counters) {
+        counters = std::make_unique<PerfCounters>();
+    }
+}
+
+const PerfCounters* perfCounters() {
+    return counters.get();
+}
@@ -0,0 +1,61 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Аппаратные счётчики через perf_event_open (только Linux): такты,
+// инструкции, промахи L1d и последнего уровня кэша, ошибки предсказания
+// переходов, плюс программный счётчик страничных промахов. Каждый счётчик
+// открывается отдельно: если ядро, виртуальная машина или
+// perf_event_paranoid не дают какой-то из них, остальные работают, а
+// недоступный помечается. Счётчики считают только поток, который их открыл.
+
+enum class HardwareEvent {
+    Cycles, Instructions, L1dMisses, LlcMisses, BranchMisses, PageFaults,
+    Count
+};
+
+const char *hardwareEventName(HardwareEvent event);
+
+struct HardwareCounters {
+    uint64_t values[static_cast<size_t>(HardwareEvent::Count)] = {};
+    uint32_t valid = 0;             // битовая маска доступных счётчиков
+
+    bool has(HardwareEvent event) const { return valid & (1u << static_cast<unsigned>(event)); }
+    uint64_t operator[](HardwareEvent event) const { return values[static_cast<size_t>(event)]; }
+    double ipc() const;             // NAN, если нет тактов или инструкций
+
+    HardwareCounters& operator+=(const HardwareCounters& other);
+};
+
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const { return mask != 0; }
+    // Почему счётчики (или часть их) недоступны; пусто, если доступны все.
+    const std::string& unavailableReason() const { return reason; }
+
+    // Текущие показания с поправкой на мультиплексирование; разность двух
+    // снимков — счётчики за отрезок.
+    HardwareCounters read() const;
+
+private:
+    int fds[static_cast<size_t>(HardwareEvent::Count)];
+    uint32_t mask = 0;
+    std::string reason;
+};
+
+HardwareCounters operator-(const HardwareCounters& after, const HardwareCounters& before);
+
+// Счётчики потока для PhaseTimer и бенчмарков; nullptr, пока не включены.
+void enablePerfCounters(bool enabled);
+const PerfCounters* perfCounters();
+
+#endif
@@ -0,0 +1,408 @@
+#include "AllocProfile.h"
+#include "Corpus.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Нагрузочный фаззер фронтенда: ищет входы, стоимость разбора которых растёт
+// быстрее размера. Каждая форма входа — prefix + open * n + core + close * n +
+// suffix; n удваивается, для каждого размера лексер и парсер запускаются в
+// отдельном процессе (падение или зависание не роняет сам фаззер), замеряются
+// время и выделения памяти. По точкам подбирается показатель степени
+// cost ~ bytes^k; форма с k выше порога, падением или тайм-аутом попадает в
+// отчёт и минимизируется: у падения ищется наименьшее n, у сверхлинейного
+// роста — кратчайшие open/close (ddmin), на которых он сохраняется.
+// perf_fuzz [--seed N] [--cases N] [--max-bytes N] [--threshold K] [--timeout S] [--out каталог]
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Shape {
+    std::string name;
+    std::string prefix;
+    std::string open;
+    std::string core;
+    std::string close;
+    std::string suffix;
+
+    std::string build(size_t n) const {
+        std::string text;
+        text.reserve(prefix.size() + (open.size() + close.size()) * n + core.size() + suffix.size());
+        text += prefix;
+        for (size_t i = 0; i < n; ++i) text += open;
+        text += core;
+        for (size_t i = 0; i < n; ++i) text += close;
+        text += suffix;
+        return text;
+    }
+
+    size_t unit() const { return std::max<size_t>(open.size() + close.size(), 1); }
+};
+
+struct Sample {
+    size_t bytes = 0;
+    double seconds = 0;
+    uint64_t allocations = 0;
+    uint64_t allocated = 0;
+};
+
+enum class Outcome { Ok, Crash, Timeout };
+
+struct Run {
+    Outcome outcome = Outcome::Ok;
+    Sample sample;
+    int signal = 0;
+};
+
+struct Options {
+    uint64_t seed = 1;
+    size_t cases = 20;
+    size_t minBytes = 16 << 10;
+    size_t maxBytes = 4 << 20;
+    double threshold = 1.5;         // кэш и страничные промахи сами дают k ~ 1.2
+    double floorSeconds = 1e-3;     // более короткие замеры — шум, в подгонку не идут
+    double sweepSeconds = 2.0;      // размер перестаёт расти, когда один замер дольше
+    unsigned timeout = 20;
+    int repetitions = 3;
+    size_t minimiseBudget = 40;     // прогонов серии на минимизацию одной формы
+    std::string out;
+};
+
+// Лексер, парсер и удаление дерева в дочернем процессе: время — минимум по
+// повторам, выделения — за первый повтор.
+Run measure(const std::string &source, const Options &options) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        Run run;
+        run.outcome = Outcome::Crash;
+        return run;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        alarm(options.timeout);
+        enableAllocProfile(true);
+        Sample sample;
+        sample.bytes = source.size();
+        sample.seconds = 1e30;
+        for (int r = 0; r < options.repetitions; ++r) {
+            AllocCounters before = allocTotals();
+            auto start = Clock::now();
+            try {
+                std::vector<Token> tokens = Lexer(source).tokenize();
+                std::shared_ptr<ASTNode> ast = Parser(tokens).parse();
+            } catch (const std::exception &) {
+                // Ошибка разбора — тоже результат: важна её стоимость.
+            }
+            sample.seconds = std::min(sample.seconds, std::chrono::duration<double>(Clock::now() - start).count());
+            if (r == 0) {
+                AllocCounters after = allocTotals();
+                sample.allocations = after.allocations - before.allocations;
+                sample.allocated = after.bytes - before.bytes;
+            }
+        }
+        ssize_t written = write(fds[1], &sample, sizeof sample);
+        _exit(written == sizeof sample ? 0 : 1);
+    }
+    close(fds[1]);
+    Run run;
+    ssize_t got = read(fds[0], &run.sample, sizeof run.sample);
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (WIFSIGNALED(status)) {
+        run.signal = WTERMSIG(status);
+        run.outcome = run.signal == SIGALRM ? Outcome::Timeout : Outcome::Crash;
+    } else if (got != sizeof run.sample || WEXITSTATUS(status) != 0) {
+        run.outcome = Outcome::Crash;
+    }
+    run.sample.bytes = source.size();
+    return run;
+}
+
+struct Sweep {
+    std::vector<Sample> samples;
+    Outcome outcome = Outcome::Ok;
+    int signal = 0;
+    size_t lastGood = 0;            // наибольшее n без падения
+    size_t failed = 0;              // n, на котором упало
+    double timeExponent = NAN;
+    double allocationExponent = NAN;
+
+    bool superLinear(double threshold) const {
+        return timeExponent > threshold || allocationExponent > threshold;
+    }
+};
+
+// Наклон прямой МНК в координатах (log x, log y).
+double exponent(const std::vector<std::pair<double, double>> &points) {
+    if (points.size() < 3) return NAN;
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (const auto &[x, y]: points) {
+        double lx = std::log(x), ly = std::log(y);
+        sx += lx;
+        sy += ly;
+        sxx += lx * lx;
+        sxy += lx * ly;
+    }
+    double n = static_cast<double>(points.size());
+    double denominator = n * sxx - sx * sx;
+    return denominator == 0 ? NAN : (n * sxy - sx * sy) / denominator;
+}
+
+Sweep sweep(const Shape &shape, const Options &options) {
+    Sweep result;
+    size_t fixed = shape.build(0).size();
+    size_t n = std::max<size_t>(1, (options.minBytes > fixed ? options.minBytes - fixed : 0) / shape.unit());
+    for (;;) {
+        Run run = measure(shape.build(n), options);
+        if (run.outcome != Outcome::Ok) {
+            result.outcome = run.outcome;
+            result.signal = run.signal;
+            result.failed = n;
+            break;
+        }
+        result.samples.push_back(run.sample);
+        result.lastGood = n;
+        if (run.sample.bytes * 2 > options.maxBytes || run.sample.seconds > options.sweepSeconds) break;
+        n *= 2;
+    }
+
+    std::vector<std::pair<double, double>> time, allocation;
+    for (const Sample &sample: result.samples) {
+        if (sample.seconds >= options.floorSeconds) time.emplace_back(sample.bytes, sample.seconds);
+        if (sample.allocated > 0) allocation.emplace_back(sample.bytes, static_cast<double>(sample.allocated));
+    }
+    result.timeExponent = exponent(time);
+    result.allocationExponent = exponent(allocation);
+    return result;
+}
+
+// Наименьшее n, на котором форма падает (двоичный поиск между последним
+// успешным и первым упавшим).
+size_t minimiseFailure(const Shape &shape, const Sweep &found, const Options &options) {
+    size_t good = found.lastGood, bad = found.failed;
+    while (bad - good > std::max<size_t>(1, bad / 64)) {
+        size_t middle = good + (bad - good) / 2;
+        if (measure(shape.build(middle), options).outcome == Outcome::Ok) {
+            good = middle;
+        } else {
+            bad = middle;
+        }
+    }
+    return bad;
+}
+
+// ddmin по символам open и close: убираем куски, пока рост остаётся
+// сверхлинейным.
+Shape minimiseGrowth(const Shape &shape, const Options &options) {
+    Shape best = shape;
+    size_t budget = options.minimiseBudget;
+    auto stillBad = [&](const Shape &candidate) {
+        if (budget == 0 || candidate.open.size() + candidate.close.size() == 0) return false;
+        --budget;
+        Sweep result = sweep(candidate, options);
+        return result.outcome == Outcome::Ok && result.superLinear(options.threshold);
+    };
+    for (std::string Shape::*part: {&Shape::open, &Shape::close}) {
+        for (size_t chunks = 2; budget > 0 && (best.*part).size() > 1;) {
+            std::string &text = best.*part;
+            size_t size = std::max<size_t>(1, text.size() / chunks);
+            bool reduced = false;
+            for (size_t start = 0; start < text.size() && budget > 0; start += size) {
+                Shape candidate = best;
+                (candidate.*part).erase(start, size);
+                if (stillBad(candidate)) {
+                    best = candidate;
+                    reduced = true;
+                    break;
+                }
+            }
+            if (reduced) {
+                chunks = std::max<size_t>(chunks - 1, 2);
+            } else if (size == 1) {
+                break;
+            } else {
+                chunks = std::min(chunks * 2, text.size());
+            }
+        }
+    }
+    return best;
+}
+
+// Формы, на которых сверхлинейность ожидаема в первую очередь: длинные
+// лексемы, длинные списки, глубокая вложенность.
+std::vector<Shape> targetedShapes() {
+    const std::string program = "var a: real;\nbegin\n";
+    return {
+            {"string-literal", "begin\n  writeln('", "строка ", "", "", "');\nend.\n"},
+            {"unterminated-string", "begin\n  writeln('", "x", "", "", ""},
+            {"var-list", "var a0", ", a", "", "", ": real;\nbegin\nend.\n"},
+            {"local-var-list", "begin\n  var b0", ", b", "", "", " := 1;\nend.\n"},
+            {"long-identifier", "var a", "z", "", "", ": real;\nbegin\nend.\n"},
+            {"long-number", "const c = 1", "7", "", "", ";\nbegin\nend.\n"},
+            {"const-list", "const", " c = 1;", "", "", "\nbegin\nend.\n"},
+            {"statements", program, "  a := a + 1;\n", "", "", "end.\n"},
+            {"call-arguments", program + "  writeln(a", ", a", "", "", ");\nend.\n"},
+            {"expression-chain", program + "  a := a", " + a * 2", "", "", ";\nend.\n"},
+            {"comparison-chain", program + "  a := a", " < a", "", "", ";\nend.\n"},
+            {"whitespace", "begin", "\n", "", "", "end.\n"},
+            {"nested-blocks", "begin\n", "begin\n", "", "end;\n", "end.\n"},
+            {"nested-parentheses", program + "  a := ", "(", "a", ")", ";\nend.\n"},
+            {"nested-calls", program + "  a := ", "sin(", "a", ")", ";\nend.\n"},
+            {"nested-if", program, "if a < 1 then\n", "a := 1;\n", "", "end.\n"},
+            {"nested-while", program, "while a < 1 do\n", "a := 1;\n", "", "end.\n"},
+    };
+}
+
+// Случайная форма из сгенерированной программы: строка-оператор
+// повторяется, мутирует или оборачивается во вложенность.
+Shape randomShape(uint64_t seed) {
+    CorpusOptions corpus;
+    corpus.bytes = 2 << 10;
+    corpus.seed = seed;
+    std::string text = generateCorpus(corpus);
+    std::vector<size_t> lines;
+    size_t body = text.find("begin\n") + 6;
+    for (size_t i = body; i < text.size(); i = text.find('\n', i) + 1) {
+        lines.push_back(i);
+        if (text.find('\n', i) == std::string::npos) break;
+    }
+    uint64_t state = seed * 0x9e3779b97f4a7c15ULL + 1;
+    auto next = [&] {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    // Последняя строка — «end.»; она берётся, только если других нет.
+    size_t at = lines.size() > 1 ? lines[next() % (lines.size() - 1)] : lines.front();
+    size_t end = text.find('\n', at) + 1;
+    std::string line = text.substr(at, end - at);
+
+    Shape shape;
+    shape.prefix = text.substr(0, at);
+    shape.suffix = text.substr(end);
+    switch (next() % 3) {
+        case 0:
+            shape.name = "fuzz-" + std::to_string(seed) + "-repeat";
+            shape.open = line;
+            break;
+        case 1: {
+            shape.name = "fuzz-" + std::to_string(seed) + "-mutate";
+            static const char *pieces[] = {"(", ")", "'", ",", ";", ":=", "begin ", "end ", "var ", "if ", " a", "1.5", "\n"};
+            std::string mutated = line;
+            for (int m = 0, count = 1 + static_cast<int>(next() % 3); m < count && !mutated.empty(); ++m) {
+                size_t position = next() % mutated.size();
+                if (next() % 2) {
+                    mutated.erase(position, 1 + next() % 3);
+                } else {
+                    mutated.insert(position, pieces[next() % std::size(pieces)]);
+                }
+            }
+            shape.open = mutated;
+            break;
+        }
+        default: {
+            shape.name = "fuzz-" + std::to_string(seed) + "-nest";
+            static const std::pair<const char *, const char *> wrappers[] = {
+                    {"begin\n", "end;\n"}, {"if a < 1 then begin\n", "end;\n"}, {"while 1 < 0 do begin\n", "end;\n"}};
+            const auto &wrapper = wrappers[next() % std::size(wrappers)];
+            shape.open = wrapper.first;
+            shape.core = line;
+            shape.close = wrapper.second;
+            break;
+        }
+    }
+    return shape;
+}
+
+std::string printable(const std::string &text) {
+    std::string result;
+    for (char c: text) {
+        if (c == '\n') result += "\\n";
+        else result += c;
+    }
+    return result.size() > 40 ? result.substr(0, 37) + "..." : result;
+}
+
+std::string fixed(double value) {
+    if (std::isnan(value)) return "-";
+    char buffer[32];
+    std::snprintf(buffer, sizeof buffer, "%.2f", value);
+    return buffer;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--cases" && hasValue) {
+            options.cases = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--max-bytes" && hasValue) {
+            options.maxBytes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threshold" && hasValue) {
+            options.threshold = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--timeout" && hasValue) {
+            options.timeout = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--out" && hasValue) {
+            options.out = argv[++i];
+        } else {
+            std::fprintf(stderr, "perf_fuzz [--seed N] [--cases N] [--max-bytes N] [--threshold K] "
+                                 "[--timeout S] [--out каталог]\n");
+            return 2;
+        }
+    }
+
+    std::vector<Shape> shapes = targetedShapes();
+    for (size_t i = 0; i < options.cases; ++i) shapes.push_back(randomShape(options.seed + i));
+
+    std::printf("%-24s %10s %8s %8s  %s\n", "форма", "до байт", "k время", "k память", "итог");
+    size_t flagged = 0;
+    for (const Shape &shape: shapes) {
+        Sweep result = sweep(shape, options);
+        size_t largest = result.samples.empty() ? 0 : result.samples.back().bytes;
+        std::string verdict = "линейно";
+        Shape reproducer = shape;
+        size_t reproducerSize = result.lastGood;
+        if (result.outcome != Outcome::Ok) {
+            size_t smallest = minimiseFailure(shape, result, options);
+            reproducerSize = smallest;
+            verdict = std::string(result.outcome == Outcome::Timeout ? "тайм-аут" : "падение") + " (сигнал " +
+                      std::to_string(result.signal) + ") с n = " + std::to_string(smallest) + ", " +
+                      std::to_string(shape.build(smallest).size()) + " байт";
+        } else if (result.superLinear(options.threshold)) {
+            reproducer = minimiseGrowth(shape, options);
+            verdict = "СВЕРХЛИНЕЙНО, минимальный повтор '" + printable(reproducer.open) + "'" +
+                      (reproducer.close.empty() ? "" : " ... '" + printable(reproducer.close) + "'");
+        }
+        bool bad = verdict != "линейно";
+        flagged += bad;
+        std::printf("%-24s %10zu %8s %8s  %s\n", shape.name.c_str(), largest, fixed(result.timeExponent).c_str(),
+                    fixed(result.allocationExponent).c_str(), verdict.c_str());
+        std::fflush(stdout);
+        if (bad && !options.out.empty()) {
+            std::ofstream file(options.out + "/" + shape.name + ".pas", std::ios::binary);
+            file << reproducer.build(std::max<size_t>(reproducerSize, 1));
+        }
+    }
+    std::printf("Подозрительных форм: %zu из %zu\n", flagged, shapes.size());
+    return flagged ? 1 : 0;
+}
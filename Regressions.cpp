@@ -0,0 +1,273 @@
+#include "ConstFold.h"
+#include "Cse.h"
+#include "Driver.h"
+#include "ExprDag.h"
+#include "Interpreter.h"
+#include "Jit.h"
+#include "Licm.h"
+#include "OutputBuffer.h"
+#include "Ssa.h"
+#include "Tiered.h"
+#include "VM.h"
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Регрессионные проверки исполнения: каждая программа разбирается заново,
+// выполняется всеми исполнителями без проходов и после проходов случая, и
+// вывод (или текст ошибки) сравнивается с ожидаемым. Так же ловятся
+// расхождения исполнителей между собой.
+// regressions — код возврата 1, если хоть один прогон не совпал.
+
+namespace {
+
+// Проходы, которые применяются к дереву случая (битовая маска).
+constexpr unsigned FOLD = 1;
+constexpr unsigned SSA = 2;
+constexpr unsigned LICM = 4;
+constexpr unsigned CSE = 8;
+
+struct Case {
+    const char *name;
+    unsigned passes;
+    const char *source;
+    const char *input;
+    const char *expected;
+};
+
+const Case CASES[] = {
+        {"fold: объявление в выбранной ветви if", FOLD, R"(
+var k: real;
+begin
+  readln(k);
+  if 1 > 0 then var q := k;
+  q := q * 2;
+  writeln(q);
+end.
+)", "4", "8\n"},
+        {"fold: объявление в отброшенной ветви if", FOLD, R"(
+var k: real;
+begin
+  readln(k);
+  if 1 > 1 then var q := k;
+  q := 3;
+  writeln(q);
+end.
+)", "4", "3\n"},
+        {"fold и ssa: объявление во вложенном if отброшенной ветви", FOLD | SSA, R"(
+var k: real;
+begin
+  readln(k);
+  if 1 > 1 then if k > 0 then var q := k;
+  q := 3;
+  writeln(q);
+end.
+)", "4", "3\n"},
+        {"ssa: объявление в выбранной ветви if", SSA, R"(
+var k, c: real;
+begin
+  readln(k);
+  c := 1;
+  if c > 0 then var q := k;
+  q := q * 2;
+  writeln(q);
+end.
+)", "4", "8\n"},
+        {"ssa: объявления в отброшенных ветвях if и в теле невыполнимого цикла", SSA, R"(
+var k, c: real;
+begin
+  readln(k);
+  c := 1;
+  if c > 1 then var q := k;
+  if c > 0 then writeln(c); else var p := k;
+  while c > 1 do var r := k;
+  q := 3;
+  p := q + 1;
+  r := p + 1;
+  writeln(q, ' ', p, ' ', r);
+end.
+)", "4", "1\n3 4 5\n"},
+        {"licm: тело цикла без begin/end объявляет переменную", LICM, R"(
+var k, i: real;
+begin
+  readln(k);
+  i := 0;
+  while i < 0 do var z := sin(k) * 2 + i;
+  writeln(z);
+  if k > 0 then while i < 0 do var w := sin(k) * 2 + i;
+  writeln(w);
+  while i < 2 do
+  begin
+    if k > 0 then while i > 5 do var v := sin(k) * 2 + i;
+    v := 1;
+    writeln(v + i);
+    i := i + 1;
+  end;
+end.
+)", "4", "0\n0\n1\n2\n"},
+        {"licm: вынесенное целое выражение присваивается integer", LICM, R"(
+var k, n, i: integer;
+begin
+  readln(k);
+  i := 0;
+  while i < 3 do
+  begin
+    n := k * 2 + i;
+    i := i + 1;
+  end;
+  writeln(n);
+end.
+)", "5", "12\n"},
+        {"объявление без инициализатора в теле цикла обнуляет переменную", FOLD | SSA | LICM | CSE, R"(
+var i: real;
+begin
+  i := 0;
+  while i < 3 do
+  begin
+    var t: real;
+    writeln(t);
+    t := i + 1;
+    i := i + 1;
+  end;
+end.
+)", "", "0\n0\n0\n"},
+        {"NaN с разными знаками одинаков во всех исполнителях", SSA | CSE, R"(
+var k, p, n, i: real;
+begin
+  readln(k);
+  n := sqrt(k - 1);
+  p := abs(n);
+  i := 0;
+  while i < 3 do
+  begin
+    writeln(p + n, ' ', n + p, ' ', p * n, ' ', n * p, ' ', p - n, ' ', n / p);
+    i := i + 1;
+  end;
+end.
+)", "0", "nan nan nan nan nan nan\nnan nan nan nan nan nan\nnan nan nan nan nan nan\n"},
+        {"var без типа с целым инициализатором — real", FOLD | SSA | LICM | CSE, R"(
+var i: real;
+begin
+  var s := 0;
+  i := 0;
+  while i < 4 do
+  begin
+    s := s + 0.5;
+    i := i + 1;
+  end;
+  writeln(s);
+end.
+)", "", "2\n"},
+        {"присваивание константе отвергается", 0, R"(
+const c = 2;
+begin
+  c := 5;
+  writeln(c);
+end.
+)", "", "Ошибка: Нельзя присвоить значение константе c\n"},
+        {"readln в константу отвергается", 0, R"(
+const c = 2;
+begin
+  readln(c);
+  writeln(c);
+end.
+)", "7", "Ошибка: readln не читает в константу c\n"},
+        {"readln в integer не принимает дробное число", 0, R"(
+var n: integer;
+begin
+  readln(n);
+  writeln(n);
+end.
+)", "2.5", "Ошибка: Ожидалось целое число при вводе\n"},
+};
+
+using Engine = std::function<void(ASTNode &, std::istream &, OutputBuffer &)>;
+
+struct NamedEngine {
+    const char *name;
+    Engine run;
+};
+
+void applyPasses(std::shared_ptr<ASTNode> &ast, unsigned passes) {
+    if (passes & FOLD) foldConstants(ast);
+    if (passes & SSA) optimizeSsa(ast);
+    if (passes & LICM) hoistLoopInvariants(ast);
+    if (passes & CSE) {
+        eliminateCommonSubexpressions(ast);
+        shareExpressions(ast);
+    }
+}
+
+// Вывод программы через OutputBuffer во временный файл; ошибка — её текстом.
+std::string execute(const Case &test, const Engine &engine, unsigned passes) {
+    std::FILE *file = std::tmpfile();
+    if (!file) throw std::runtime_error("Не удалось создать временный файл");
+    std::string result;
+    try {
+        ParseResult parsed = Driver().parseSource(test.source);
+        applyPasses(parsed.ast, passes);
+        std::istringstream in(test.input);
+        OutputBuffer out(fileno(file));
+        engine(*parsed.ast, in, out);
+    } catch (std::exception &ex) {
+        result = std::string("Ошибка: ") + ex.what() + "\n";
+    }
+    std::rewind(file);
+    std::string output;
+    char chunk[4096];
+    while (size_t n = std::fread(chunk, 1, sizeof chunk, file)) output.append(chunk, n);
+    std::fclose(file);
+    return output + result;
+}
+
+// Текст ошибки исполнители дополняют по-разному (интерпретатор называет
+// переменную), поэтому у ожидаемой ошибки сравнивается только начало.
+bool matches(const std::string &output, const std::string &expected) {
+    std::string prefix = "Ошибка: ";
+    if (expected.compare(0, prefix.size(), prefix) != 0) return output == expected;
+    std::string message = expected.substr(0, expected.size() - 1);
+    return output.compare(0, message.size(), message) == 0;
+}
+
+}
+
+int main() {
+    std::vector<NamedEngine> engines{
+            {"ast", [](ASTNode &program, std::istream &in, OutputBuffer &out) { Interpreter(in, out).run(program); }},
+            {"vm", [](ASTNode &program, std::istream &in, OutputBuffer &out) { VM(in, out).run(program); }},
+    };
+    if (jitSupported()) {
+        engines.push_back({"jit", [](ASTNode &program, std::istream &in, OutputBuffer &out) {
+            runWithJit(program, in, out);
+        }});
+    }
+    engines.push_back({"tiered", [](ASTNode &program, std::istream &in, OutputBuffer &out) {
+        // Низкие пороги: короткие циклы тоже проходят все уровни.
+        TierConfig config;
+        config.bytecodeThreshold = 1;
+        config.nativeThreshold = 2;
+        TieredEngine(in, out, config).run(program);
+    }});
+
+    size_t failures = 0;
+    size_t runs = 0;
+    for (const Case &test: CASES) {
+        for (unsigned passes: {0u, test.passes}) {
+            for (const NamedEngine &engine: engines) {
+                ++runs;
+                std::string output = execute(test, engine.run, passes);
+                if (matches(output, test.expected)) continue;
+                ++failures;
+                std::cerr << "НЕ СОВПАЛО: " << test.name << " [" << engine.name
+                          << (passes ? ", с проходами" : "") << "]\n  ожидалось: " << test.expected
+                          << "  получено:   " << output;
+            }
+        }
+    }
+    std::cerr << "Прогонов: " << runs << ", расхождений: " << failures << std::endl;
+    return failures ? 1 : 0;
+}
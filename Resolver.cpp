@@ -0,0 +1,179 @@
+#include "Resolver.h"
+#include "AstVisitor.h"
+#include "Builtins.h"
+#include "FlatMap.h"
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+class NameResolver : public AstVisitor<NameResolver> {
+public:
+    Resolution resolution;
+    std::vector<std::string> diagnostics;
+
+    NameResolver() { openScope(); }
+
+    bool enterStatementBlock(ASTNode &node) {
+        node.slot = openScope();
+        return true;
+    }
+
+    void leaveStatementBlock(ASTNode &) { closeScope(); }
+
+    bool enterConstDecl(ASTNode &node) {
+        if (node.children.size() == 1 && node.children[0]->isNumber()) {
+            for (const auto &name: declaredNames(node)) {
+                declare(node, name);
+                resolution.initialFrame[node.slot] = node.children[0]->number;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    // Инициализатор локальной переменной разрешается до её объявления.
+    void leaveVarDecl(ASTNode &node) {
+        auto names = declaredNames(node);
+        int first = -1, symbol = -1;
+        for (size_t i = 0; i < names.size(); ++i) {
+            declare(node, names[i]);
+            if (i == 0) {
+                first = node.slot;
+                symbol = node.symbol;
+            }
+        }
+        node.slot = first;
+        node.symbol = symbol;
+    }
+
+    bool enterAssignment(ASTNode &node) {
+        lookup(node);
+        return true;
+    }
+
+    bool enterProcedureCall(ASTNode &node) {
+        Procedure procedure;
+        if (!findProcedure(node.value, procedure)) {
+            error("Неизвестная процедура: " + node.value);
+            return true;
+        }
+        node.slot = static_cast<int>(procedure);
+        if (procedure == Procedure::Readln) {
+            for (const auto &arg: node.children) {
+                if (arg->type != ASTNodeType::Factor || arg->factor != FactorKind::Name) {
+                    error("Аргументом readln должна быть переменная");
+                }
+            }
+        }
+        return true;
+    }
+
+    bool enterFactor(ASTNode &node) {
+        switch (node.factor) {
+            case FactorKind::Name:
+                lookup(node);
+                break;
+            case FactorKind::Call: {
+                const Builtin *builtin = findBuiltin(node.value);
+                if (!builtin) {
+                    error("Неизвестная функция: " + node.value);
+                } else if (node.children.size() != 1) {
+                    error("Функция " + node.value + " принимает один аргумент");
+                } else {
+                    node.slot = static_cast<int>(builtin - BUILTINS);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        return true;
+    }
+
+private:
+    // Видимое объявление имени. shadowed — объявление того же имени, которое
+    // оно скрывает (номер в bindings + 1, 0 — нет).
+    struct Binding {
+        uint32_t symbol;
+        int slot;
+        int depth;
+        int shadowed;
+    };
+
+    std::vector<Binding> bindings;
+    FlatMap<int> visible;                // имя -> номер в bindings + 1, 0 — не видно
+    std::vector<int> openScopes;         // номера в resolution.scopes
+    std::vector<size_t> scopeMarks;      // размер bindings при входе в область
+
+    void error(std::string message) { diagnostics.push_back(std::move(message)); }
+
+    int openScope() {
+        Scope scope;
+        scope.parent = openScopes.empty() ? -1 : openScopes.back();
+        scope.depth = static_cast<int>(openScopes.size());
+        resolution.scopes.push_back(std::move(scope));
+        openScopes.push_back(static_cast<int>(resolution.scopes.size() - 1));
+        scopeMarks.push_back(bindings.size());
+        return openScopes.back();
+    }
+
+    void closeScope() {
+        while (bindings.size() > scopeMarks.back()) {
+            const Binding &binding = bindings.back();
+            visible[binding.symbol] = binding.shadowed;
+            bindings.pop_back();
+        }
+        scopeMarks.pop_back();
+        openScopes.pop_back();
+    }
+
+    void declare(ASTNode &node, const std::string &name) {
+        uint32_t symbol = resolution.symbols.intern(name);
+        int depth = static_cast<int>(openScopes.size()) - 1;
+        int &current = visible[symbol];
+        if (current != 0 && bindings[current - 1].depth == depth) {
+            error("Повторное объявление: " + name);
+        }
+
+        int slot = static_cast<int>(resolution.frameSize++);
+        resolution.initialFrame.push_back(0.0);
+        bindings.push_back({symbol, slot, depth, current});
+        current = static_cast<int>(bindings.size());
+
+        Scope &scope = resolution.scopes[openScopes.back()];
+        scope.symbols.push_back(symbol);
+        scope.slots.push_back(slot);
+        node.symbol = static_cast<int>(symbol);
+        node.scopeDepth = depth;
+        node.slot = slot;
+    }
+
+    void lookup(ASTNode &node) {
+        uint32_t symbol = resolution.symbols.intern(node.value);
+        node.symbol = static_cast<int>(symbol);
+        const int *found = visible.find(symbol);
+        if (!found || *found == 0) {
+            error("Неизвестное имя: " + node.value);
+            return;
+        }
+        const Binding &binding = bindings[*found - 1];
+        node.scopeDepth = binding.depth;
+        node.slot = binding.slot;
+    }
+};
+
+}
+
+Resolution resolveNames(ASTNode &program) {
+    NameResolver resolver;
+    resolver.traverse(program);
+    if (!resolver.diagnostics.empty()) {
+        std::string message = resolver.diagnostics[0];
+        for (size_t i = 1; i < resolver.diagnostics.size(); ++i) {
+            message += "\n" + resolver.diagnostics[i];
+        }
+        throw std::runtime_error(message);
+    }
+    return std::move(resolver.resolution);
+}
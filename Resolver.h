@@ -0,0 +1,37 @@
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+#include "AST.h"
+#include "Interner.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Область видимости: программа (глубина 0) и каждый StatementBlock.
+struct Scope {
+    int parent = -1;                    // -1 у внешней области
+    int depth = 0;
+    std::vector<uint32_t> symbols;      // объявленные имена в порядке объявления
+    std::vector<int> slots;             // их ячейки кадра
+};
+
+struct Resolution {
+    size_t frameSize = 0;
+    std::vector<double> initialFrame;   // значения констант, остальные ячейки — 0
+    Interner symbols;                   // номера в ASTNode::symbol
+    std::vector<Scope> scopes;          // дерево областей; StatementBlock::slot — номер области
+    std::vector<ValueType> slotTypes;   // типы ячеек кадра, заполняет checkTypes
+};
+
+// Семантический проход по программе. Строит дерево областей видимости и
+// привязывает каждое имя (объявление, присваивание, использование, аргумент
+// readln) к интернированному номеру (ASTNode::symbol), глубине объявившей
+// области (ASTNode::scopeDepth) и ячейке кадра (ASTNode::slot). Каждое
+// объявление получает собственную ячейку. Вызовы функций разрешаются в
+// номера встроенных функций, вызовы процедур — в Procedure. Поиск по
+// вложенным областям — одна проба в плоской хэш-таблице, строки не
+// сравниваются. Все ошибки (неизвестное или повторно объявленное имя,
+// неизвестная функция и т. п.) собираются и выдаются одним std::runtime_error.
+Resolution resolveNames(ASTNode &program);
+
+#endif
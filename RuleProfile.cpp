@@ -0,0 +1,214 @@
+#include "RuleProfile.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iterator>
+#include <string>
+
+namespace {
+
+constexpr size_t RULE_COUNT = static_cast<size_t>(GrammarRule::Count);
+
+// Таблица одного потока; список таблиц пополняется один раз на поток (CAS),
+// таблицы не освобождаются, чтобы счётчики завершившихся потоков дожили до
+// отчёта.
+struct ThreadProfile {
+    RuleCounters counters[RULE_COUNT];
+    unsigned active[RULE_COUNT] = {};
+    ThreadProfile *next = nullptr;
+};
+
+std::atomic<ThreadProfile*> profiles{nullptr};
+thread_local ThreadProfile *local = nullptr;
+thread_local RuleScope *top = nullptr;
+thread_local int activeRule = -1;
+
+ThreadProfile &localProfile() {
+    if (!local) {
+        local = new ThreadProfile;
+        ThreadProfile *head = profiles.load();
+        do {
+            local->next = head;
+        } while (!profiles.compare_exchange_weak(head, local));
+    }
+    return *local;
+}
+
+double ms(uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+double ratio(uint64_t a, uint64_t b) {
+    return b ? static_cast<double>(a) / static_cast<double>(b) : 0;
+}
+
+// printf выравнивает по байтам; кириллица в UTF-8 занимает два байта на символ.
+std::string pad(const std::string &text, size_t width, bool left) {
+    size_t length = 0;
+    for (char c: text) length += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    std::string spaces(width > length ? width - length : 0, ' ');
+    return left ? text + spaces : spaces + text;
+}
+
+uint64_t wasted(const RuleCounters &counters) {
+    return counters.peeks > counters.selfTokens ? counters.peeks - counters.selfTokens : 0;
+}
+
+}
+
+const char *grammarRuleName(GrammarRule rule) {
+    switch (rule) {
+        case GrammarRule::Program: return "Program";
+        case GrammarRule::Block: return "Block";
+        case GrammarRule::ConstDecl: return "ConstDecl";
+        case GrammarRule::VarDecl: return "VarDecl";
+        case GrammarRule::LocalVarDecl: return "LocalVarDecl";
+        case GrammarRule::TemplateDecl: return "TemplateDecl";
+        case GrammarRule::StatementBlock: return "StatementBlock";
+        case GrammarRule::Statement: return "Statement";
+        case GrammarRule::Assignment: return "Assignment";
+        case GrammarRule::IfStatement: return "IfStatement";
+        case GrammarRule::WhileStatement: return "WhileStatement";
+        case GrammarRule::ProcedureCall: return "ProcedureCall";
+        case GrammarRule::Expression: return "Expression";
+        case GrammarRule::Additive: return "Additive";
+        case GrammarRule::Term: return "Term";
+        case GrammarRule::Factor: return "Factor";
+        case GrammarRule::Count: break;
+    }
+    return "unknown";
+}
+
+RuleCounters ruleCounters(GrammarRule rule) {
+    RuleCounters total;
+    for (ThreadProfile *profile = profiles.load(); profile; profile = profile->next) {
+        const RuleCounters &counters = profile->counters[static_cast<size_t>(rule)];
+        total.calls += counters.calls;
+        total.tokens += counters.tokens;
+        total.selfTokens += counters.selfTokens;
+        total.peeks += counters.peeks;
+        total.lookahead += counters.lookahead;
+        total.selfNs += counters.selfNs;
+        total.inclusiveNs += counters.inclusiveNs;
+    }
+    return total;
+}
+
+void resetRuleProfile() {
+    for (ThreadProfile *profile = profiles.load(); profile; profile = profile->next) {
+        std::fill(std::begin(profile->counters), std::end(profile->counters), RuleCounters{});
+    }
+}
+
+void noteRulePeek(size_t distance) {
+    if (activeRule < 0) return;
+    RuleCounters &counters = localProfile().counters[activeRule];
+    // Текущий токен — одно обращение; просмотр на distance вперёд читает
+    // distance токенов за ним.
+    counters.peeks += distance ? distance : 1;
+    counters.lookahead += distance;
+}
+
+RuleScope::RuleScope(GrammarRule rule, const size_t &position)
+        : rule(rule), position(position), startPosition(position), parent(top) {
+    ThreadProfile &profile = localProfile();
+    ++profile.counters[static_cast<size_t>(rule)].calls;
+    ++profile.active[static_cast<size_t>(rule)];
+    top = this;
+    activeRule = static_cast<int>(rule);
+    start = std::chrono::steady_clock::now();
+}
+
+RuleScope::~RuleScope() {
+    auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    uint64_t tokens = position > startPosition ? position - startPosition : 0;
+    ThreadProfile &profile = *local;
+    RuleCounters &counters = profile.counters[static_cast<size_t>(rule)];
+    counters.selfNs += ns > childNs ? ns - childNs : 0;
+    counters.selfTokens += tokens > childTokens ? tokens - childTokens : 0;
+    if (--profile.active[static_cast<size_t>(rule)] == 0) {
+        counters.inclusiveNs += ns;
+        counters.tokens += tokens;
+    }
+    if (parent) {
+        parent->childNs += ns;
+        parent->childTokens += tokens;
+    }
+    top = parent;
+    activeRule = parent ? static_cast<int>(parent->rule) : -1;
+}
+
+void printRuleProfile(std::ostream &out, bool json) {
+    RuleCounters all[RULE_COUNT];
+    uint64_t totalNs = 0;
+    uint64_t totalPeeks = 0;
+    uint64_t totalWasted = 0;
+    for (size_t r = 0; r < RULE_COUNT; ++r) {
+        all[r] = ruleCounters(static_cast<GrammarRule>(r));
+        totalNs += all[r].selfNs;
+        totalPeeks += all[r].peeks;
+        totalWasted += wasted(all[r]);
+    }
+    size_t order[RULE_COUNT];
+    for (size_t r = 0; r < RULE_COUNT; ++r) order[r] = r;
+    std::stable_sort(order, order + RULE_COUNT, [&](size_t a, size_t b) { return all[a].selfNs > all[b].selfNs; });
+
+    // Сколько уровней выражения проходит каждый операнд: Expression, Additive
+    // и Term вызываются на каждый Factor, даже когда операторов нет.
+    const RuleCounters &factor = all[static_cast<size_t>(GrammarRule::Factor)];
+    uint64_t descent = all[static_cast<size_t>(GrammarRule::Expression)].calls +
+                       all[static_cast<size_t>(GrammarRule::Additive)].calls +
+                       all[static_cast<size_t>(GrammarRule::Term)].calls + factor.calls;
+    uint64_t tokens = all[static_cast<size_t>(GrammarRule::Program)].tokens;
+
+    char line[256];
+    if (json) {
+        out << "{\"tokens\": " << tokens << ", \"self_ns\": " << totalNs << ", \"peeks\": " << totalPeeks
+            << ", \"wasted_peeks\": " << totalWasted;
+        std::snprintf(line, sizeof line, ", \"calls_per_operand\": %.3f", ratio(descent, factor.calls));
+        out << line << ", \"rules\": [";
+        bool first = true;
+        for (size_t r: order) {
+            const RuleCounters &counters = all[r];
+            if (!counters.calls) continue;
+            out << (first ? "" : ", ") << "{\"rule\": \"" << grammarRuleName(static_cast<GrammarRule>(r))
+                << "\", \"calls\": " << counters.calls << ", \"tokens\": " << counters.tokens
+                << ", \"self_tokens\": " << counters.selfTokens << ", \"peeks\": " << counters.peeks
+                << ", \"lookahead\": " << counters.lookahead << ", \"wasted_peeks\": " << wasted(counters)
+                << ", \"self_ns\": " << counters.selfNs << ", \"inclusive_ns\": " << counters.inclusiveNs << "}";
+            first = false;
+        }
+        out << "]}\n";
+        return;
+    }
+
+    std::snprintf(line, sizeof line, "Профиль правил: токенов %llu, собственное время %.3f мс\n",
+                  static_cast<unsigned long long>(tokens), ms(totalNs));
+    out << line;
+    const char *columns[] = {"вызовов", "токенов", "собств.", "заглядыв.", "вперёд", "впустую", "на ток.",
+                             "собств. мс", "всего мс", "%"};
+    const size_t widths[] = {10, 10, 10, 10, 9, 10, 8, 11, 11, 6};
+    out << "  " << pad("правило", 15, true);
+    for (size_t c = 0; c < std::size(columns); ++c) out << " " << pad(columns[c], widths[c], false);
+    out << "\n";
+    for (size_t r: order) {
+        const RuleCounters &counters = all[r];
+        if (!counters.calls) continue;
+        std::snprintf(line, sizeof line, "  %-15s %10llu %10llu %10llu %10llu %9llu %10llu %8.2f %11.3f %11.3f %5.1f%%\n",
+                      grammarRuleName(static_cast<GrammarRule>(r)), static_cast<unsigned long long>(counters.calls),
+                      static_cast<unsigned long long>(counters.tokens),
+                      static_cast<unsigned long long>(counters.selfTokens),
+                      static_cast<unsigned long long>(counters.peeks),
+                      static_cast<unsigned long long>(counters.lookahead),
+                      static_cast<unsigned long long>(wasted(counters)),
+                      ratio(counters.peeks, counters.selfTokens), ms(counters.selfNs), ms(counters.inclusiveNs),
+                      100 * ratio(counters.selfNs, totalNs));
+        out << line;
+    }
+    std::snprintf(line, sizeof line,
+                  "  заглядываний %llu, из них впустую %llu (%.1f%%); вызовов правил выражения на операнд %.2f\n",
+                  static_cast<unsigned long long>(totalPeeks), static_cast<unsigned long long>(totalWasted),
+                  100 * ratio(totalWasted, totalPeeks), ratio(descent, factor.calls));
+    out << line;
+}
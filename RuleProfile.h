@@ -0,0 +1,72 @@
+#ifndef RULEPROFILE_H
+#define RULEPROFILE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Профиль правил грамматики: для каждого parse* — вызовы, поглощённые
+// токены (всего и собственные), собственное и полное время, и заглядывания:
+// обращения к текущему токену и просмотр вперёд (isLocalVarDecl,
+// tokens[current + 1]). Заглядывания сверх поглощённых токенов — впустую
+// повторённые проверки. Включается при сборке (-DANALYZER_RULE_PROFILE=ON);
+// без флага RULE(...) и RULE_PEEK(...) в Parser.cpp раскрываются в пустоту.
+
+enum class GrammarRule {
+    Program, Block, ConstDecl, VarDecl, LocalVarDecl, TemplateDecl, StatementBlock, Statement,
+    Assignment, IfStatement, WhileStatement, ProcedureCall, Expression, Additive, Term, Factor,
+    Count
+};
+
+const char *grammarRuleName(GrammarRule rule);
+
+struct RuleCounters {
+    uint64_t calls = 0;
+    uint64_t tokens = 0;            // поглощено вместе с вложенными правилами
+    uint64_t selfTokens = 0;
+    uint64_t peeks = 0;             // собственные обращения к токенам, включая просмотр вперёд
+    uint64_t lookahead = 0;         // из них дальше текущего токена
+    uint64_t selfNs = 0;
+    uint64_t inclusiveNs = 0;       // tokens и inclusiveNs считаются по внешнему вызову:
+                                    // рекурсия правила в себя их не удваивает
+};
+
+// Сумма по всем потокам. Читать и сбрасывать после завершения рабочих
+// потоков: их таблицы не синхронизируются.
+RuleCounters ruleCounters(GrammarRule rule);
+void resetRuleProfile();
+// Правила по убыванию собственного времени.
+void printRuleProfile(std::ostream &out, bool json);
+
+// Заглядывание на distance токенов от текущего (0 — сам текущий).
+void noteRulePeek(size_t distance);
+
+// Кадр вызова правила; position — ссылка на индекс текущего токена парсера.
+class RuleScope {
+public:
+    RuleScope(GrammarRule rule, const size_t &position);
+    ~RuleScope();
+
+    RuleScope(const RuleScope&) = delete;
+    RuleScope& operator=(const RuleScope&) = delete;
+
+private:
+    GrammarRule rule;
+    const size_t &position;
+    size_t startPosition;
+    uint64_t childTokens = 0;
+    uint64_t childNs = 0;
+    RuleScope *parent;
+    std::chrono::steady_clock::time_point start;
+};
+
+#ifdef ANALYZER_RULE_PROFILE
+#define RULE(name) RuleScope ruleScope(GrammarRule::name, current)
+#define RULE_PEEK(distance) noteRulePeek(distance)
+#else
+#define RULE(name)
+#define RULE_PEEK(distance)
+#endif
+
+#endif
@@ -0,0 +1,466 @@
+#include "AstDumper.h"
+#include "Cfg.h"
+#include "Corpus.h"
+#include "Dataflow.h"
+#include "Driver.h"
+#include "OutputBuffer.h"
+#include "Parser.h"
+#include "Trace.h"
+#include "TypeChecker.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+// Сквозной замер конвейера чтение -> лексер -> парсер -> анализ -> вывод на
+// сетке «размер корпуса x число потоков». Для каждой точки сетки — несколько
+// повторов в отдельных процессах (пиковая память процесса не копится между
+// точками); по повторам — среднее и 95% доверительный интервал времени фаз,
+// общего времени и пиковой памяти, пропускная способность. Результат можно
+// сохранить как базовый и сравнивать с ним следующие прогоны: изменение по
+// каждой фазе с интервалом и показатель роста времени фазы от размера.
+// --trace пишет трассу ещё одного прогона (наибольший размер, наибольшее
+// число потоков) в формате Chrome trace_event.
+// scaling_study [--sizes 64k,512k,4m] [--threads 1,2,4] [--files N] [--repetitions N]
+//               [--seed N] [--format text|json|sexpr] [--save файл] [--baseline файл]
+//               [--tolerance P] [--csv файл] [--trace файл.json]
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum Phase { READ, LEX, PARSE, ANALYSE, DUMP, PHASES };
+
+const char *PHASE_NAMES[PHASES] = {"read", "lex", "parse", "analyse", "dump"};
+
+struct Measurement {
+    double phaseSeconds[PHASES] = {};   // сумма по файлам во всех потоках
+    double wallSeconds = 0;
+    double peakRssBytes = 0;
+    bool failed = false;
+};
+
+struct Options {
+    std::vector<size_t> sizes{64 << 10, 512 << 10, 4 << 20};
+    std::vector<size_t> threads{1, 2, 4};
+    size_t files = 4;
+    size_t repetitions = 5;
+    uint64_t seed = 1;
+    DumpFormat format = DumpFormat::Text;
+    std::string save;
+    std::string baseline;
+    std::string csv;
+    std::string trace;
+    double tolerance = 5;               // процентов; меньшие изменения не считаются регрессией
+};
+
+// Один прогон: файлы делятся между потоками через общий счётчик.
+Measurement runPipeline(const std::vector<std::string> &paths, size_t threads, DumpFormat format) {
+    Measurement measurement;
+    std::vector<Measurement> perThread(threads);
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    auto worker = [&](Measurement &own, size_t index) {
+        setTraceThreadName("worker " + std::to_string(index));
+        int sink = open("/dev/null", O_WRONLY);
+        OutputBuffer out(sink);
+        for (size_t i; (i = next.fetch_add(1)) < paths.size();) {
+            try {
+                TraceSpan file("file", "driver", paths[i]);
+                auto t0 = Clock::now();
+                std::string source;
+                {
+                    TraceSpan span("read", "io");
+                    source = Driver::readFile(paths[i]);
+                }
+                auto t1 = Clock::now();
+                std::vector<Token> tokens;
+                {
+                    TraceSpan span("lex", "frontend");
+                    tokens = Lexer(source).tokenize();
+                }
+                auto t2 = Clock::now();
+                std::shared_ptr<ASTNode> ast;
+                {
+                    TraceSpan span("parse", "frontend");
+                    ast = Parser(tokens).parse();
+                }
+                auto t3 = Clock::now();
+                {
+                    TraceSpan span("analyse", "passes");
+                    Resolution resolution = resolveNames(*ast);
+                    checkTypes(*ast, resolution);
+                    Cfg cfg = buildCfg(*ast, resolution.frameSize);
+                    DataflowResult live = liveVariables(cfg);
+                    DataflowResult assigned = definitelyAssigned(cfg);
+                    reachingDefinitions(cfg, buildDominators(cfg), live);
+                    dataflowWarnings(cfg, live, assigned);
+                }
+                auto t4 = Clock::now();
+                {
+                    TraceSpan span("dump", "output");
+                    dumpTokens(out, tokens, format);
+                    dumpAst(out, *ast, format);
+                    out.flush();
+                }
+                auto t5 = Clock::now();
+                auto seconds = [](auto from, auto to) { return std::chrono::duration<double>(to - from).count(); };
+                own.phaseSeconds[READ] += seconds(t0, t1);
+                own.phaseSeconds[LEX] += seconds(t1, t2);
+                own.phaseSeconds[PARSE] += seconds(t2, t3);
+                own.phaseSeconds[ANALYSE] += seconds(t3, t4);
+                own.phaseSeconds[DUMP] += seconds(t4, t5);
+            } catch (const std::exception &ex) {
+                std::fprintf(stderr, "%s: Ошибка: %s\n", paths[i].c_str(), ex.what());
+                failed = true;
+            }
+        }
+        close(sink);
+    };
+
+    auto start = Clock::now();
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t) pool.emplace_back(worker, std::ref(perThread[t]), t);
+    worker(perThread[0], 0);
+    for (auto &thread: pool) thread.join();
+    measurement.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (const Measurement &own: perThread) {
+        for (int p = 0; p < PHASES; ++p) measurement.phaseSeconds[p] += own.phaseSeconds[p];
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    measurement.peakRssBytes = static_cast<double>(usage.ru_maxrss) * 1024;
+    measurement.failed = failed;
+    return measurement;
+}
+
+Measurement runIsolated(const std::vector<std::string> &paths, size_t threads, DumpFormat format) {
+    int fds[2];
+    Measurement measurement;
+    measurement.failed = true;
+    if (pipe(fds) != 0) return measurement;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        Measurement result = runPipeline(paths, threads, format);
+        ssize_t written = write(fds[1], &result, sizeof result);
+        _exit(written == sizeof result ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], &measurement, sizeof measurement);
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (got != sizeof measurement || !WIFEXITED(status) || WEXITSTATUS(status) != 0) measurement.failed = true;
+    return measurement;
+}
+
+// Среднее, стандартное отклонение и число повторов одной величины.
+struct Summary {
+    double mean = 0;
+    double sd = 0;
+    size_t n = 0;
+};
+
+Summary summarize(const std::vector<double> &values) {
+    Summary summary;
+    summary.n = values.size();
+    if (values.empty()) return summary;
+    for (double v: values) summary.mean += v;
+    summary.mean /= static_cast<double>(values.size());
+    if (values.size() > 1) {
+        double squares = 0;
+        for (double v: values) squares += (v - summary.mean) * (v - summary.mean);
+        summary.sd = std::sqrt(squares / static_cast<double>(values.size() - 1));
+    }
+    return summary;
+}
+
+// Квантиль распределения Стьюдента для двустороннего 95% интервала.
+double studentT(size_t degrees) {
+    static const double TABLE[] = {12.71, 4.30, 3.18, 2.78, 2.57, 2.45, 2.36, 2.31, 2.26, 2.23};
+    if (degrees == 0) return NAN;
+    if (degrees <= std::size(TABLE)) return TABLE[degrees - 1];
+    return 1.96 + 2.4 / static_cast<double>(degrees);
+}
+
+double halfWidth(const Summary &summary) {
+    return summary.n < 2 ? 0 : studentT(summary.n - 1) * summary.sd / std::sqrt(static_cast<double>(summary.n));
+}
+
+// Ключ записи: размер, потоки, метрика (фаза, wall или rss).
+using Key = std::tuple<size_t, size_t, std::string>;
+using Records = std::map<Key, Summary>;
+
+void saveRecords(const Records &records, const std::string &path) {
+    std::ofstream file(path);
+    if (!file) throw std::runtime_error("Не удалось открыть " + path);
+    file << "# scaling_study: байты потоки метрика среднее отклонение повторов\n";
+    file.precision(9);
+    for (const auto &[key, summary]: records) {
+        file << std::get<0>(key) << ' ' << std::get<1>(key) << ' ' << std::get<2>(key) << ' ' << summary.mean
+             << ' ' << summary.sd << ' ' << summary.n << '\n';
+    }
+    if (!file) throw std::runtime_error("Ошибка записи " + path);
+}
+
+Records loadRecords(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Не удалось открыть базовый файл: " + path);
+    Records records;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream in(line);
+        size_t bytes, threads;
+        std::string metric;
+        Summary summary;
+        if (!(in >> bytes >> threads >> metric >> summary.mean >> summary.sd >> summary.n)) {
+            throw std::runtime_error("Неверная строка базового файла: " + line);
+        }
+        records[{bytes, threads, metric}] = summary;
+    }
+    return records;
+}
+
+// Показатель k в time ~ bytes^k по средним одной метрики при одном числе
+// потоков (МНК в логарифмах).
+double growthExponent(const Records &records, size_t threads, const std::string &metric) {
+    std::vector<std::pair<double, double>> points;
+    for (const auto &[key, summary]: records) {
+        if (std::get<1>(key) == threads && std::get<2>(key) == metric && summary.mean > 0) {
+            points.emplace_back(std::log(static_cast<double>(std::get<0>(key))), std::log(summary.mean));
+        }
+    }
+    if (points.size() < 2) return NAN;
+    double sx = 0, sy = 0, sxx = 0, sxy = 0, n = static_cast<double>(points.size());
+    for (const auto &[x, y]: points) {
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double denominator = n * sxx - sx * sx;
+    return denominator == 0 ? NAN : (n * sxy - sx * sy) / denominator;
+}
+
+// Сравнение с базовым прогоном; возвращает число регрессий.
+size_t compare(const Records &current, const Records &baseline, const Options &options) {
+    std::printf("\nСравнение с базовым прогоном (изменение среднего, 95%% интервал):\n");
+    std::printf("%10s %7s %-8s %12s %12s %9s %9s  %s\n", "байт", "потоков", "метрика", "было", "стало", "%",
+                "±%", "итог");
+    size_t regressions = 0;
+    std::set<Key> regressed;
+    for (const auto &[key, now]: current) {
+        auto found = baseline.find(key);
+        if (found == baseline.end() || found->second.mean <= 0) continue;
+        const Summary &before = found->second;
+        double delta = (now.mean - before.mean) / before.mean * 100;
+        size_t degrees = std::min(now.n, before.n);
+        double spread = std::sqrt(now.sd * now.sd / static_cast<double>(std::max<size_t>(now.n, 1)) +
+                                  before.sd * before.sd / static_cast<double>(std::max<size_t>(before.n, 1)));
+        double half = degrees < 2 ? 0 : studentT(degrees - 1) * spread / before.mean * 100;
+        const char *verdict = "";
+        if (delta - half > options.tolerance) {
+            verdict = "РЕГРЕССИЯ";
+            ++regressions;
+            regressed.insert(key);
+        } else if (delta + half < -options.tolerance) {
+            verdict = "улучшение";
+        }
+        // Время — в миллисекундах, память — в мегабайтах.
+        double scale = std::get<2>(key) == "rss" ? 1.0 / (1 << 20) : 1e3;
+        std::printf("%10zu %7zu %-8s %12.3f %12.3f %+9.1f %9.1f  %s\n", std::get<0>(key), std::get<1>(key),
+                    std::get<2>(key).c_str(), before.mean * scale, now.mean * scale, delta, half, verdict);
+    }
+
+    std::printf("\nРост от размера (k в время ~ байты^k):\n");
+    std::vector<std::string> metrics(PHASE_NAMES, PHASE_NAMES + PHASES);
+    metrics.push_back("wall");
+    for (size_t threads: options.threads) {
+        for (const auto &metric: metrics) {
+            double was = growthExponent(baseline, threads, metric), now = growthExponent(current, threads, metric);
+            if (std::isnan(was) || std::isnan(now)) continue;
+            // Рост показателя по шумным точкам — ещё не регрессия: нужен и
+            // значимый рост времени на самом большом размере.
+            bool worse = now > was + 0.15 && now > 1.15 &&
+                         regressed.count({options.sizes.back(), threads, metric});
+            regressions += worse;
+            std::printf("  потоков %zu, %-8s %.2f -> %.2f%s\n", threads, metric.c_str(), was, now,
+                        worse ? "  РЕГРЕССИЯ" : "");
+        }
+    }
+    return regressions;
+}
+
+std::vector<size_t> parseList(const std::string &text, bool sizes) {
+    std::vector<size_t> values;
+    for (size_t start = 0; start <= text.size();) {
+        size_t comma = std::min(text.find(',', start), text.size());
+        if (comma > start) {
+            std::string item = text.substr(start, comma - start);
+            size_t end = 0;
+            double value = std::stod(item, &end);
+            double scale = 1;
+            if (sizes && end < item.size()) {
+                switch (item[end]) {
+                    case 'k': case 'K': scale = 1 << 10; break;
+                    case 'm': case 'M': scale = 1 << 20; break;
+                    default: throw std::invalid_argument(item);
+                }
+            }
+            values.push_back(static_cast<size_t>(value * scale));
+        }
+        start = comma + 1;
+    }
+    if (values.empty() || std::find(values.begin(), values.end(), 0) != values.end()) {
+        throw std::invalid_argument(text);
+    }
+    return values;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--sizes" && hasValue) {
+                options.sizes = parseList(argv[++i], true);
+            } else if (arg == "--threads" && hasValue) {
+                options.threads = parseList(argv[++i], false);
+            } else if (arg == "--files" && hasValue) {
+                options.files = std::max<size_t>(1, std::stoul(argv[++i]));
+            } else if (arg == "--repetitions" && hasValue) {
+                options.repetitions = std::max<size_t>(1, std::stoul(argv[++i]));
+            } else if (arg == "--seed" && hasValue) {
+                options.seed = std::stoull(argv[++i]);
+            } else if (arg == "--format" && hasValue) {
+                if (!parseDumpFormat(argv[++i], options.format)) throw std::invalid_argument(argv[i]);
+            } else if (arg == "--save" && hasValue) {
+                options.save = argv[++i];
+            } else if (arg == "--baseline" && hasValue) {
+                options.baseline = argv[++i];
+            } else if (arg == "--tolerance" && hasValue) {
+                options.tolerance = std::stod(argv[++i]);
+            } else if (arg == "--csv" && hasValue) {
+                options.csv = argv[++i];
+            } else if (arg == "--trace" && hasValue) {
+                options.trace = argv[++i];
+            } else {
+                std::fprintf(stderr, "scaling_study [--sizes 64k,512k,4m] [--threads 1,2,4] [--files N] "
+                                     "[--repetitions N] [--seed N] [--format text|json|sexpr] [--save файл] "
+                                     "[--baseline файл] [--tolerance P] [--csv файл] [--trace файл.json]\n");
+                return 2;
+            }
+        }
+    } catch (const std::exception &) {
+        std::fprintf(stderr, "Неверное значение параметра\n");
+        return 2;
+    }
+
+    namespace fs = std::filesystem;
+    std::string pattern = (fs::temp_directory_path() / "scaling_study.XXXXXX").string();
+    if (!mkdtemp(pattern.data())) {
+        std::fprintf(stderr, "Не удалось создать временный каталог\n");
+        return 1;
+    }
+    fs::path directory = pattern;
+
+    int status = 0;
+    try {
+        Records records;
+        std::ofstream csv;
+        if (!options.csv.empty()) {
+            csv.open(options.csv);
+            if (!csv) throw std::runtime_error("Не удалось открыть " + options.csv);
+            csv << "bytes,threads,metric,mean,ci95,throughput_mb_s\n";
+        }
+        std::printf("%10s %7s %9s %9s %9s %9s %9s %12s %9s %9s\n", "байт", "потоков", "чтение мс", "лексер мс",
+                    "парсер мс", "анализ мс", "вывод мс", "всего мс", "МБ/с", "пик МБ");
+        std::vector<std::string> tracePaths;
+        for (size_t bytes: options.sizes) {
+            // Разные seed у файлов одного размера: потоки не разбирают одно и то же.
+            std::vector<std::string> paths;
+            size_t total = 0;
+            for (size_t f = 0; f < options.files; ++f) {
+                CorpusOptions corpus;
+                corpus.bytes = bytes;
+                corpus.seed = options.seed + f;
+                fs::path path = directory / ("corpus" + std::to_string(bytes) + "_" + std::to_string(f) + ".pas");
+                std::ofstream file(path, std::ios::binary);
+                generateCorpus(corpus, file);
+                total += static_cast<size_t>(file.tellp());
+                paths.push_back(path.string());
+            }
+            tracePaths = paths;
+            for (size_t threads: options.threads) {
+                std::vector<double> values[PHASES + 2];
+                for (size_t r = 0; r < options.repetitions; ++r) {
+                    Measurement m = runIsolated(paths, threads, options.format);
+                    if (m.failed) throw std::runtime_error("Прогон конвейера завершился с ошибкой");
+                    for (int p = 0; p < PHASES; ++p) values[p].push_back(m.phaseSeconds[p]);
+                    values[PHASES].push_back(m.wallSeconds);
+                    values[PHASES + 1].push_back(m.peakRssBytes);
+                }
+                Summary summaries[PHASES + 2];
+                for (int p = 0; p < PHASES + 2; ++p) summaries[p] = summarize(values[p]);
+                for (int p = 0; p < PHASES; ++p) records[{bytes, threads, PHASE_NAMES[p]}] = summaries[p];
+                records[{bytes, threads, "wall"}] = summaries[PHASES];
+                records[{bytes, threads, "rss"}] = summaries[PHASES + 1];
+
+                const Summary &wall = summaries[PHASES];
+                double throughput = static_cast<double>(total) / wall.mean / 1e6;
+                std::printf("%10zu %7zu", bytes, threads);
+                for (int p = 0; p < PHASES; ++p) std::printf(" %9.1f", summaries[p].mean * 1e3);
+                std::printf(" %7.1f±%-6.1f %9.1f %9.1f\n", wall.mean * 1e3, halfWidth(wall) * 1e3, throughput,
+                            summaries[PHASES + 1].mean / (1 << 20));
+                std::fflush(stdout);
+                if (csv.is_open()) {
+                    for (int p = 0; p < PHASES + 2; ++p) {
+                        const char *metric = p < PHASES ? PHASE_NAMES[p] : p == PHASES ? "wall" : "rss";
+                        csv << bytes << ',' << threads << ',' << metric << ',' << summaries[p].mean << ','
+                            << halfWidth(summaries[p]) << ',' << (p == PHASES ? throughput : 0) << '\n';
+                    }
+                }
+            }
+        }
+        if (!options.trace.empty()) {
+            enableTracing(true);
+            runPipeline(tracePaths, *std::max_element(options.threads.begin(), options.threads.end()),
+                        options.format);
+            enableTracing(false);
+            writeTrace(options.trace);
+        }
+        if (!options.baseline.empty()) {
+            size_t regressions = compare(records, loadRecords(options.baseline), options);
+            std::printf("Регрессий: %zu\n", regressions);
+            if (regressions) status = 1;
+        }
+        if (!options.save.empty()) saveRecords(records, options.save);
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "Ошибка: %s\n", ex.what());
+        status = 1;
+    }
+    std::error_code ignored;
+    fs::remove_all(directory, ignored);
+    return status;
+}
@@ -0,0 +1,632 @@
+#include "Ssa.h"
+#include "AstVisitor.h"
+#include "Builtins.h"
+#include "ConstFold.h"
+#include "TypeChecker.h"
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+
+namespace {
+
+class SsaBuilder {
+public:
+    SsaBuilder(SsaForm &ssa, const Resolution &resolution) : ssa(ssa), resolution(resolution) {}
+
+    void build() {
+        const Cfg &cfg = ssa.cfg;
+        size_t blocks = cfg.blocks.size();
+        MergePoints points = placeMerges(cfg, ssa.dominators, nullptr);
+
+        // Слияния создаются заранее: операнды заполняет предшественник,
+        // который может встретиться в обходе раньше самого блока.
+        ssa.phiStart = points.start;
+        for (uint32_t b = 0; b < blocks; ++b) {
+            for (uint32_t m = points.start[b]; m < points.start[b + 1]; ++m) {
+                SsaValue phi;
+                phi.kind = SsaValue::Kind::Phi;
+                phi.a = static_cast<uint32_t>(ssa.phiOperands.size());
+                phi.b = cfg.blocks[b].predecessorCount;
+                phi.block = b;
+                phi.home = static_cast<int>(points.slots[m]);
+                ssa.values.push_back(phi);
+                ssa.phiOperands.resize(ssa.phiOperands.size() + phi.b, SsaForm::None);
+            }
+        }
+        ssa.bodyStart.assign(blocks, 0);
+        ssa.bodyEnd.assign(blocks, 0);
+        ssa.conditions.assign(blocks, SsaForm::None);
+
+        // Начальные значения кадра — константы (нули и значения const).
+        current.resize(cfg.variables);
+        for (size_t slot = 0; slot < cfg.variables; ++slot) {
+            current[slot] = constant(resolution.initialFrame[slot], cfg.entry);
+        }
+
+        const auto &idom = ssa.dominators.idom;
+        for (uint32_t b: ssa.dominators.preorder) {
+            while (!path.empty() && path.back().first != idom[b]) {
+                for (size_t mark = path.back().second; undo.size() > mark; undo.pop_back()) {
+                    current[undo.back().first] = undo.back().second;
+                }
+                path.pop_back();
+            }
+            path.emplace_back(b, undo.size());
+
+            block = b;
+            for (uint32_t m = ssa.phiStart[b]; m < ssa.phiStart[b + 1]; ++m) {
+                define(points.slots[m], m);
+            }
+            ssa.bodyStart[b] = static_cast<uint32_t>(ssa.values.size());
+            const BasicBlock &basic = cfg.blocks[b];
+            for (uint32_t s = basic.firstStatement; s < basic.firstStatement + basic.statementCount; ++s) {
+                statement(*cfg.statements[s]);
+            }
+            ssa.bodyEnd[b] = static_cast<uint32_t>(ssa.values.size());
+
+            for (int32_t successor: basic.successors) {
+                if (successor < 0) continue;
+                const BasicBlock &target = cfg.blocks[successor];
+                uint32_t position = 0;
+                while (cfg.predecessors[target.firstPredecessor + position] != b) ++position;
+                for (uint32_t m = ssa.phiStart[successor]; m < ssa.phiStart[successor + 1]; ++m) {
+                    ssa.phiOperands[ssa.values[m].a + position] = current[points.slots[m]];
+                }
+            }
+        }
+    }
+
+private:
+    SsaForm &ssa;
+    const Resolution &resolution;
+    uint32_t block = 0;
+    std::vector<uint32_t> current;                          // текущее значение каждой ячейки
+    std::vector<std::pair<uint32_t, uint32_t>> undo;       // (ячейка, прежнее значение)
+    std::vector<std::pair<uint32_t, size_t>> path;         // (блок, размер журнала при входе)
+
+    void define(uint32_t slot, uint32_t value) {
+        undo.emplace_back(slot, current[slot]);
+        current[slot] = value;
+        if (ssa.values[value].home < 0) ssa.values[value].home = static_cast<int>(slot);
+    }
+
+    uint32_t add(SsaValue value) {
+        value.block = block;
+        ssa.values.push_back(value);
+        return static_cast<uint32_t>(ssa.values.size() - 1);
+    }
+
+    uint32_t constant(double number, uint32_t in) {
+        SsaValue value;
+        value.number = number;
+        value.block = in;
+        ssa.values.push_back(value);
+        return static_cast<uint32_t>(ssa.values.size() - 1);
+    }
+
+    void statement(const ASTNode &node) {
+        switch (node.type) {
+            case ASTNodeType::ConstDecl:
+                define(node.slot, constant(resolution.initialFrame[node.slot], block));
+                return;
+            case ASTNodeType::VarDecl: {
+                uint32_t value = expression(*node.children[0]);
+                for (size_t i = 0, n = declaredNames(node).size(); i < n; ++i) {
+                    define(node.slot + static_cast<uint32_t>(i), value);
+                }
+                return;
+            }
+            case ASTNodeType::Assignment:
+                define(node.slot, expression(*node.children[0]));
+                return;
+            case ASTNodeType::ProcedureCall:
+                for (const auto &arg: node.children) {
+                    if (static_cast<Procedure>(node.slot) == Procedure::Readln) {
+                        SsaValue input;
+                        input.kind = SsaValue::Kind::Input;
+                        define(arg->slot, add(input));
+                    } else if (arg->type != ASTNodeType::Factor || arg->factor != FactorKind::String) {
+                        expression(*arg);
+                    }
+                }
+                return;
+            case ASTNodeType::IfStatement:
+            case ASTNodeType::WhileStatement:
+                ssa.conditions[block] = expression(*node.children[0]);
+                return;
+            default:
+                return;
+        }
+    }
+
+    uint32_t expression(const ASTNode &node) {
+        uint32_t result = SsaForm::None;
+        SsaValue value;
+        switch (node.type) {
+            case ASTNodeType::Expression:
+            case ASTNodeType::Term:
+                value.op = binaryOp(node.value);
+                if (value.op == BinaryOp::Invalid || node.children.size() != 2) break;
+                value.kind = SsaValue::Kind::Binary;
+                value.a = expression(*node.children[0]);
+                value.b = expression(*node.children[1]);
+                result = add(value);
+                break;
+            case ASTNodeType::Factor:
+                if (node.factor == FactorKind::Number) {
+                    result = constant(node.number, block);
+                } else if (node.factor == FactorKind::Name) {
+                    result = current[node.slot];
+                    int home = ssa.values[result].home;
+                    if (home >= 0 && home != node.slot && current[home] == result) ssa.copies[&node] = home;
+                } else if (node.factor == FactorKind::Call && node.children.size() == 1) {
+                    value.kind = SsaValue::Kind::Call;
+                    value.a = expression(*node.children[0]);
+                    value.b = static_cast<uint32_t>(node.slot);
+                    result = add(value);
+                }
+                break;
+            default:
+                break;
+        }
+        if (result == SsaForm::None) {
+            // Невычислимое выражение: о его значении ничего не известно.
+            value.kind = SsaValue::Kind::Input;
+            result = add(value);
+        }
+        ssa.nodeValues[&node] = result;
+        return result;
+    }
+};
+
+// Решётка SCCP: неизвестно (ещё не вычислялось) -> константа -> переменно.
+enum class Lattice : uint8_t { Top, Constant, Bottom };
+
+struct ConstantPropagation {
+    std::vector<Lattice> state;
+    std::vector<double> number;
+    std::vector<uint8_t> blockExecutable;
+    std::vector<uint8_t> edgeExecutable;        // блок * 2 + номер преемника
+};
+
+bool sameNumber(double a, double b) {
+    return std::memcmp(&a, &b, sizeof a) == 0;
+}
+
+// Разреженное условное распространение констант: два списка работ — дуги
+// графа, ставшие выполнимыми, и значения SSA, чей элемент решётки опустился.
+class ConstantPropagator {
+public:
+    explicit ConstantPropagator(const SsaForm &ssa) : ssa(ssa) {}
+
+    ConstantPropagation run() {
+        size_t count = ssa.values.size(), blocks = ssa.cfg.blocks.size();
+        result.state.assign(count, Lattice::Top);
+        result.number.assign(count, 0.0);
+        result.blockExecutable.assign(blocks, 0);
+        result.edgeExecutable.assign(blocks * 2, 0);
+        linkUsers();
+
+        // Начальные значения кадра лежат во входном блоке вне его тела.
+        for (uint32_t v = 0; v < count; ++v) {
+            if (ssa.values[v].kind == SsaValue::Kind::Constant) lower(v, Lattice::Constant, ssa.values[v].number);
+        }
+        reach(ssa.cfg.entry);
+        while (!blockWork.empty() || !valueWork.empty()) {
+            while (!blockWork.empty()) {
+                uint32_t b = blockWork.back();
+                blockWork.pop_back();
+                for (uint32_t v = ssa.phiStart[b]; v < ssa.phiStart[b + 1]; ++v) evaluate(v);
+                for (uint32_t v = ssa.bodyStart[b]; v < ssa.bodyEnd[b]; ++v) evaluate(v);
+                branch(b);
+            }
+            while (!valueWork.empty()) {
+                uint32_t v = valueWork.back();
+                valueWork.pop_back();
+                for (uint32_t u = userStart[v]; u < userStart[v + 1]; ++u) evaluate(users[u]);
+                for (uint32_t c = conditionStart[v]; c < conditionStart[v + 1]; ++c) branch(conditionBlocks[c]);
+            }
+        }
+        return std::move(result);
+    }
+
+private:
+    const SsaForm &ssa;
+    ConstantPropagation result;
+    std::vector<uint32_t> userStart, users;
+    std::vector<uint32_t> conditionStart, conditionBlocks;
+    std::vector<uint32_t> blockWork, valueWork;
+
+    // Обратные связи «значение -> его пользователи» в плоских массивах.
+    void linkUsers() {
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        for (uint32_t v = 0; v < ssa.values.size(); ++v) {
+            const SsaValue &value = ssa.values[v];
+            switch (value.kind) {
+                case SsaValue::Kind::Binary:
+                    pairs.emplace_back(value.a, v);
+                    pairs.emplace_back(value.b, v);
+                    break;
+                case SsaValue::Kind::Call:
+                    pairs.emplace_back(value.a, v);
+                    break;
+                case SsaValue::Kind::Phi:
+                    for (uint32_t i = value.a; i < value.a + value.b; ++i) {
+                        if (ssa.phiOperands[i] != SsaForm::None) pairs.emplace_back(ssa.phiOperands[i], v);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        group(pairs, userStart, users);
+        pairs.clear();
+        for (uint32_t b = 0; b < ssa.conditions.size(); ++b) {
+            if (ssa.conditions[b] != SsaForm::None) pairs.emplace_back(ssa.conditions[b], b);
+        }
+        group(pairs, conditionStart, conditionBlocks);
+    }
+
+    void group(const std::vector<std::pair<uint32_t, uint32_t>> &pairs, std::vector<uint32_t> &start,
+               std::vector<uint32_t> &items) {
+        start.assign(ssa.values.size() + 1, 0);
+        for (const auto &pair: pairs) ++start[pair.first + 1];
+        for (size_t i = 1; i < start.size(); ++i) start[i] += start[i - 1];
+        items.resize(pairs.size());
+        std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+        for (const auto &pair: pairs) items[fill[pair.first]++] = pair.second;
+    }
+
+    void reach(uint32_t block) {
+        if (result.blockExecutable[block]) return;
+        result.blockExecutable[block] = 1;
+        blockWork.push_back(block);
+    }
+
+    void markEdge(uint32_t block, int successor) {
+        int32_t target = ssa.cfg.blocks[block].successors[successor];
+        uint8_t &edge = result.edgeExecutable[block * 2 + successor];
+        if (target < 0 || edge) return;
+        edge = 1;
+        if (result.blockExecutable[target]) {
+            // Новая входящая дуга меняет только слияния.
+            for (uint32_t v = ssa.phiStart[target]; v < ssa.phiStart[target + 1]; ++v) evaluate(v);
+        } else {
+            reach(static_cast<uint32_t>(target));
+        }
+    }
+
+    void branch(uint32_t block) {
+        if (!result.blockExecutable[block]) return;
+        uint32_t condition = ssa.conditions[block];
+        if (condition == SsaForm::None) {
+            markEdge(block, 0);
+            return;
+        }
+        switch (result.state[condition]) {
+            case Lattice::Top:
+                return;
+            case Lattice::Constant:
+                markEdge(block, result.number[condition] != 0.0 ? 0 : 1);
+                return;
+            case Lattice::Bottom:
+                markEdge(block, 0);
+                markEdge(block, 1);
+                return;
+        }
+    }
+
+    void lower(uint32_t v, Lattice state, double number) {
+        Lattice &current = result.state[v];
+        if (state == current && (state != Lattice::Constant || sameNumber(number, result.number[v]))) return;
+        // Разные константы на входах — переменное значение.
+        if (current == Lattice::Bottom) return;
+        if (current == Lattice::Constant && state == Lattice::Constant) state = Lattice::Bottom;
+        current = state;
+        result.number[v] = number;
+        valueWork.push_back(v);
+    }
+
+    void evaluate(uint32_t v) {
+        const SsaValue &value = ssa.values[v];
+        if (!result.blockExecutable[value.block]) return;
+        const auto &state = result.state;
+        const auto &number = result.number;
+        switch (value.kind) {
+            case SsaValue::Kind::Constant:
+                return;
+            case SsaValue::Kind::Input:
+                lower(v, Lattice::Bottom, 0.0);
+                return;
+            case SsaValue::Kind::Binary:
+                if (state[value.a] == Lattice::Bottom || state[value.b] == Lattice::Bottom) {
+                    lower(v, Lattice::Bottom, 0.0);
+                } else if (state[value.a] == Lattice::Constant && state[value.b] == Lattice::Constant) {
+                    lower(v, Lattice::Constant, applyBinary(value.op, number[value.a], number[value.b]));
+                }
+                return;
+            case SsaValue::Kind::Call:
+                if (state[value.a] == Lattice::Bottom || !BUILTINS[value.b].pure) {
+                    lower(v, Lattice::Bottom, 0.0);
+                } else if (state[value.a] == Lattice::Constant) {
+                    lower(v, Lattice::Constant, BUILTINS[value.b].fn(number[value.a]));
+                }
+                return;
+            case SsaValue::Kind::Phi: {
+                // Учитываются только операнды с выполнимых входящих дуг.
+                const BasicBlock &block = ssa.cfg.blocks[value.block];
+                for (uint32_t i = 0; i < value.b; ++i) {
+                    uint32_t operand = ssa.phiOperands[value.a + i];
+                    uint32_t from = ssa.cfg.predecessors[block.firstPredecessor + i];
+                    int edge = ssa.cfg.blocks[from].successors[0] == static_cast<int32_t>(value.block) ? 0 : 1;
+                    if (operand == SsaForm::None || !result.edgeExecutable[from * 2 + edge]) continue;
+                    if (state[operand] != Lattice::Top) lower(v, state[operand], number[operand]);
+                    if (result.state[v] == Lattice::Bottom) return;
+                }
+                return;
+            }
+        }
+    }
+};
+
+// Видимость ячейки по её имени в области scope: имя не должно быть скрыто
+// объявлением во вложенной области.
+class SlotScopes {
+public:
+    explicit SlotScopes(const Resolution &resolution) : resolution(resolution) {
+        scopeOf.assign(resolution.frameSize, -1);
+        symbolOf.assign(resolution.frameSize, 0);
+        for (size_t s = 0; s < resolution.scopes.size(); ++s) {
+            const Scope &scope = resolution.scopes[s];
+            for (size_t i = 0; i < scope.slots.size(); ++i) {
+                scopeOf[scope.slots[i]] = static_cast<int>(s);
+                symbolOf[scope.slots[i]] = scope.symbols[i];
+            }
+        }
+    }
+
+    bool visible(int slot, int scope) const {
+        for (int s = scope; s >= 0; s = resolution.scopes[s].parent) {
+            if (s == scopeOf[slot]) return true;
+            for (uint32_t symbol: resolution.scopes[s].symbols) {
+                if (symbol == symbolOf[slot]) return false;
+            }
+        }
+        return false;
+    }
+
+    const std::string &name(int slot) const { return resolution.symbols.name(symbolOf[slot]); }
+
+private:
+    const Resolution &resolution;
+    std::vector<int> scopeOf;
+    std::vector<uint32_t> symbolOf;
+};
+
+using NodePtr = std::shared_ptr<ASTNode>;
+
+// Перенос результатов SCCP и копий обратно в AST.
+class SsaRewriter : public AstRewriter<SsaRewriter> {
+public:
+    SsaRewriter(const SsaForm &ssa, const ConstantPropagation &constants, const Resolution &resolution,
+                SsaStats &stats)
+            : ssa(ssa), constants(constants), resolution(resolution), scopes(resolution), stats(stats) {
+        for (uint32_t b = 0; b < ssa.cfg.blocks.size(); ++b) {
+            if (ssa.cfg.blocks[b].branch) branchBlocks[ssa.cfg.blocks[b].branch] = b;
+        }
+    }
+
+    bool enterConstDecl(ASTNode &) { return false; }
+
+    // Аргументы readln — приёмники значений, а не выражения.
+    bool enterProcedureCall(ASTNode &node) { return node.value != "readln"; }
+
+    bool enterStatementBlock(ASTNode &node) {
+        openScopes.push_back(node.slot);
+        return true;
+    }
+
+    NodePtr rewriteStatementBlock(const NodePtr &node) {
+        openScopes.pop_back();
+        return node;
+    }
+
+    // В постоянное подвыражение не спускаемся: оно заменяется целиком.
+    bool enterExpression(ASTNode &node) { return !constantOf(node); }
+    bool enterTerm(ASTNode &node) { return !constantOf(node); }
+    bool enterFactor(ASTNode &node) { return !constantOf(node); }
+
+    NodePtr rewriteExpression(const NodePtr &node) { return literal(node); }
+    NodePtr rewriteTerm(const NodePtr &node) { return literal(node); }
+
+    NodePtr rewriteFactor(const NodePtr &node) {
+        if (node->factor != FactorKind::Name) return node->isNumber() ? node : literal(node);
+        if (constantOf(*node)) return literal(node);
+        auto copy = ssa.copies.find(node.get());
+        if (copy == ssa.copies.end()) return node;
+        int source = copy->second;
+        // Тип источника может быть уже (integer в real), а от типа зависит
+        // вывод типов локальных переменных — такие копии не трогаем.
+        if (resolution.slotTypes[source] != resolution.slotTypes[node->slot] ||
+            !scopes.visible(source, openScopes.back())) {
+            return node;
+        }
+        ++stats.copies;
+        node->value = scopes.name(source);
+        node->slot = source;
+        return node;
+    }
+
+    NodePtr rewriteIfStatement(const NodePtr &node) {
+        auto found = branchBlocks.find(node.get());
+        if (found == branchBlocks.end() || !constants.blockExecutable[found->second]) return node;
+        bool thenTaken = constants.edgeExecutable[found->second * 2];
+        bool elseTaken = constants.edgeExecutable[found->second * 2 + 1];
+        if (thenTaken == elseTaken) return node;
+        if (thenTaken && node->children.size() > 2 && declaresIntoEnclosingBlock(node->children[2])) return node;
+        if (elseTaken && declaresIntoEnclosingBlock(node->children[1])) return node;
+        ++stats.prunedBranches;
+        if (thenTaken) return node->children[1];
+        if (node->children.size() > 2) return node->children[2];
+        return makeEmptyStatement();
+    }
+
+    NodePtr rewriteWhileStatement(const NodePtr &node) {
+        auto found = branchBlocks.find(node.get());
+        if (found == branchBlocks.end() || !constants.blockExecutable[found->second] ||
+            constants.edgeExecutable[found->second * 2] || declaresIntoEnclosingBlock(node->children[1])) {
+            return node;
+        }
+        ++stats.prunedBranches;
+        return makeEmptyStatement();
+    }
+
+private:
+    const SsaForm &ssa;
+    const ConstantPropagation &constants;
+    const Resolution &resolution;
+    SlotScopes scopes;
+    SsaStats &stats;
+    std::unordered_map<const ASTNode *, uint32_t> branchBlocks;
+    std::vector<int> openScopes{0};
+
+    // Бесконечность и NaN литералом не записать — они остаются вычислением.
+    bool constantOf(const ASTNode &node) const {
+        if (node.isNumber()) return false;
+        auto found = ssa.nodeValues.find(&node);
+        if (found == ssa.nodeValues.end()) return false;
+        return constants.state[found->second] == Lattice::Constant && std::isfinite(constants.number[found->second]);
+    }
+
+    NodePtr literal(const NodePtr &node) {
+        if (!constantOf(*node)) return node;
+        ++stats.constants;
+        return makeLiteral(constants.number[ssa.nodeValues.at(node.get())], node->valueType);
+    }
+};
+
+// Удаление мёртвых присваиваний: от операторов с внешним эффектом (вывод,
+// assert, readln) и условий ветвлений по цепочкам достигающих определений
+// отмечаются нужные записи; остальные присваивания удаляются.
+class DeadStoreRewriter : public AstRewriter<DeadStoreRewriter> {
+public:
+    DeadStoreRewriter(std::vector<const ASTNode *> dead, std::vector<uint8_t> slotUsed, SsaStats &stats)
+            : dead(dead.begin(), dead.end()), slotUsed(std::move(slotUsed)), stats(stats) {}
+
+    bool enterExpression(ASTNode &) { return false; }
+    bool enterTerm(ASTNode &) { return false; }
+    bool enterFactor(ASTNode &) { return false; }
+
+    // Пустой оператор вместо удаления: ветвь if должна остаться на месте.
+    NodePtr rewriteAssignment(const NodePtr &node) {
+        if (!dead.count(node.get())) return node;
+        ++stats.deadStores;
+        return makeEmptyStatement();
+    }
+
+    NodePtr rewriteVarDecl(const NodePtr &node) {
+        if (!dead.count(node.get())) return node;
+        ++stats.deadStores;
+        bool used = false;
+        for (size_t i = 0, n = declaredNames(*node).size(); i < n; ++i) used |= slotUsed[node->slot + i];
+        if (!used) return makeEmptyStatement();
+        // Имя ещё нужно другим записям: остаётся объявление с дешёвым
+        // инициализатором того же типа.
+        node->children[0] = makeLiteral(0.0, node->children[0]->valueType);
+        return node;
+    }
+
+private:
+    std::unordered_set<const ASTNode *> dead;
+    std::vector<uint8_t> slotUsed;
+    SsaStats &stats;
+};
+
+void removeDeadStores(NodePtr &root, SsaStats &stats) {
+    Resolution resolution = resolveNames(*root);
+    Cfg cfg = buildCfg(*root, resolution.frameSize);
+    DataflowResult live = liveVariables(cfg);
+    Dominators dominators = buildDominators(cfg);
+    ReachingDefinitions reaching = reachingDefinitions(cfg, dominators, live);
+
+    std::vector<uint32_t> statementOf(cfg.accesses.size());
+    for (uint32_t s = 0; s < cfg.statements.size(); ++s) {
+        for (uint32_t a = cfg.accessStart[s]; a < cfg.accessStart[s + 1]; ++a) statementOf[a] = s;
+    }
+
+    auto accessCount = static_cast<uint32_t>(cfg.accesses.size());
+    std::vector<uint8_t> statementLive(cfg.statements.size(), 0), mergeLive(reaching.merges.size(), 0);
+    std::vector<uint32_t> work;
+    auto markStatement = [&](uint32_t s) {
+        if (statementLive[s]) return;
+        statementLive[s] = 1;
+        work.push_back(s);
+    };
+    for (uint32_t s = 0; s < cfg.statements.size(); ++s) {
+        ASTNodeType type = cfg.statements[s]->type;
+        if (type != ASTNodeType::Assignment && type != ASTNodeType::VarDecl) markStatement(s);
+    }
+    std::vector<uint32_t> values;
+    while (!work.empty()) {
+        uint32_t s = work.back();
+        work.pop_back();
+        for (const Access *a = cfg.accessBegin(s); a != cfg.accessEnd(s); ++a) {
+            if (a->write) continue;
+            values.push_back(reaching.reaching[a - cfg.accesses.data()]);
+            while (!values.empty()) {
+                uint32_t value = values.back();
+                values.pop_back();
+                if (value == ReachingDefinitions::Initial) continue;
+                if (value < accessCount) {
+                    markStatement(statementOf[value]);
+                    continue;
+                }
+                uint32_t m = value - accessCount;
+                if (mergeLive[m]) continue;
+                mergeLive[m] = 1;
+                const auto &merge = reaching.merges[m];
+                uint32_t count = cfg.blocks[merge.block].predecessorCount;
+                values.insert(values.end(), reaching.operands.begin() + merge.firstOperand,
+                              reaching.operands.begin() + merge.firstOperand + count);
+            }
+        }
+    }
+
+    std::vector<const ASTNode *> dead;
+    std::vector<uint8_t> slotUsed(cfg.variables, 0);
+    for (uint32_t s = 0; s < cfg.statements.size(); ++s) {
+        if (!statementLive[s]) {
+            dead.push_back(cfg.statements[s]);
+            continue;
+        }
+        for (const Access *a = cfg.accessBegin(s); a != cfg.accessEnd(s); ++a) slotUsed[a->slot] = 1;
+    }
+    if (dead.empty()) return;
+    DeadStoreRewriter rewriter(std::move(dead), std::move(slotUsed), stats);
+    root = rewriter.rewrite(root);
+}
+
+}
+
+SsaForm buildSsa(const ASTNode &program, const Resolution &resolution) {
+    SsaForm ssa;
+    ssa.cfg = buildCfg(program, resolution.frameSize);
+    ssa.dominators = buildDominators(ssa.cfg);
+    SsaBuilder(ssa, resolution).build();
+    return ssa;
+}
+
+SsaStats optimizeSsa(std::shared_ptr<ASTNode> &root) {
+    SsaStats stats;
+    Resolution resolution = resolveNames(*root);
+    checkTypes(*root, resolution);
+    {
+        SsaForm ssa = buildSsa(*root, resolution);
+        ConstantPropagation constants = ConstantPropagator(ssa).run();
+        SsaRewriter rewriter(ssa, constants, resolution, stats);
+        root = rewriter.rewrite(root);
+    }
+    // После подстановки констант и копий часть записей больше не читается.
+    removeDeadStores(root, stats);
+    return stats;
+}
@@ -0,0 +1,74 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include "AST.h"
+#include "Cfg.h"
+#include "Dataflow.h"
+#include "Resolver.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Значение SSA-формы. Запись в ячейку кадра нового значения не создаёт, а
+// только даёт имя уже вычисленному: после `fa := fx` у fa то же значение,
+// что у fx.
+struct SsaValue {
+    enum class Kind : uint8_t {
+        Constant,   // number
+        Phi,        // слияние на входе block, операнды — phiOperands[a, a + b)
+        Binary,     // op над значениями a и b
+        Call,       // BUILTINS[b] от значения a
+        Input       // прочитано readln: до выполнения неизвестно
+    };
+
+    Kind kind = Kind::Constant;
+    BinaryOp op = BinaryOp::Invalid;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    double number = 0.0;
+    uint32_t block = 0;
+    int home = -1;          // ячейка, куда значение записано впервые; -1 — промежуточное
+};
+
+// SSA-форма разрешённой программы поверх её графа потока управления.
+// Слияния ставятся без усечения по живости (см. placeMerges), поэтому в
+// любой точке известно текущее значение каждой ячейки.
+struct SsaForm {
+    static constexpr uint32_t None = UINT32_MAX;
+
+    Cfg cfg;
+    Dominators dominators;
+    std::vector<SsaValue> values;
+    std::vector<uint32_t> phiOperands;      // по предшественникам блока; None — с недостижимого
+    // Значения блока b: слияния [phiStart[b], phiStart[b + 1]) и вычисленные
+    // в нём [bodyStart[b], bodyEnd[b]).
+    std::vector<uint32_t> phiStart;
+    std::vector<uint32_t> bodyStart;
+    std::vector<uint32_t> bodyEnd;
+    std::vector<uint32_t> conditions;       // значение условия ветвления блока или None
+    std::unordered_map<const ASTNode *, uint32_t> nodeValues;   // выражения и чтения имён
+    // Чтения, значение которых в этой точке лежит и в ячейке, куда оно было
+    // записано впервые: `fa := fx; y := fa` можно читать как `y := fx`.
+    std::unordered_map<const ASTNode *, int> copies;
+};
+
+// Строит SSA-форму: дерево доминаторов, слияния на итерированной границе
+// доминирования, переименование обходом дерева доминаторов.
+SsaForm buildSsa(const ASTNode &program, const Resolution &resolution);
+
+struct SsaStats {
+    size_t constants = 0;       // выражений и чтений заменено литералом
+    size_t copies = 0;          // чтений копии заменено чтением источника
+    size_t prunedBranches = 0;  // if/while, одна из ветвей которых не выполняется
+    size_t deadStores = 0;      // присваиваний и инициализаторов, значение которых не читается
+};
+
+// Оптимизация через SSA-форму с результатом снова в виде AST, который
+// исполняют все уровни (интерпретатор, байткод, JIT): разреженное условное
+// распространение констант (Вегман — Заддек) с учётом невыполнимых ветвей,
+// распространение копий и удаление мёртвых присваиваний.
+SsaStats optimizeSsa(std::shared_ptr<ASTNode> &root);
+
+#endif
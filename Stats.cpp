@@ -0,0 +1,183 @@
+#include "Stats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+const char *statsPhaseName(StatsPhase phase) {
+    switch (phase) {
+        case StatsPhase::Read: return "read";
+        case StatsPhase::Cache: return "cache";
+        case StatsPhase::Lex: return "lex";
+        case StatsPhase::Parse: return "parse";
+        case StatsPhase::Analyse: return "analyse";
+        case StatsPhase::Dump: return "dump";
+        case StatsPhase::Run: return "run";
+        case StatsPhase::Count: break;
+    }
+    return "unknown";
+}
+
+void PipelineStats::add(const LexerStats &stats) {
+    lexer.tokens += stats.tokens;
+    lexer.bytes += stats.bytes;
+    lexer.lines += stats.lines;
+    lexer.unknown += stats.unknown;
+}
+
+void PipelineStats::add(const ParserStats &stats) {
+    parser.nodes += stats.nodes;
+    parser.tokens += stats.tokens;
+    parser.errors += stats.errors;
+    parser.peakLookahead = std::max(parser.peakLookahead, stats.peakLookahead);
+    parser.maxDepth = std::max(parser.maxDepth, stats.maxDepth);
+}
+
+#ifdef ANALYZER_STATS
+PassTimer::PassTimer(PipelineStats &stats, const char *name)
+        : stats(stats), name(name), perf(perfCounters()) {
+    if (perf) counters = perf->read();
+    start = std::chrono::steady_clock::now();
+}
+
+PassTimer::~PassTimer() {
+    auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    HardwareCounters delta;
+    if (perf) delta = perf->read() - counters;
+    auto found = std::find_if(stats.passes.begin(), stats.passes.end(),
+                              [&](const PassStats &pass) { return std::strcmp(pass.name, name) == 0; });
+    if (found == stats.passes.end()) {
+        stats.passes.push_back({name});
+        found = stats.passes.end() - 1;
+    }
+    ++found->runs;
+    found->ns += ns;
+    found->counters += delta;
+}
+#endif
+
+namespace {
+
+const char *PHASE_TITLES[] = {"чтение", "кэш", "лексер", "парсер", "анализ", "вывод", "выполнение"};
+
+double perSecond(uint64_t count, uint64_t ns) {
+    return ns ? static_cast<double>(count) * 1e9 / static_cast<double>(ns) : 0;
+}
+
+// «IPC 1.52, cycles 1.2e+09, ...» — только доступные счётчики.
+std::string describeCounters(const HardwareCounters &counters) {
+    std::string text;
+    char item[64];
+    if (!std::isnan(counters.ipc())) {
+        std::snprintf(item, sizeof item, "IPC %.2f", counters.ipc());
+        text += item;
+    }
+    for (size_t e = 0; e < static_cast<size_t>(HardwareEvent::Count); ++e) {
+        auto event = static_cast<HardwareEvent>(e);
+        if (!counters.has(event)) continue;
+        std::snprintf(item, sizeof item, "%s%s %.3g", text.empty() ? "" : ", ", hardwareEventName(event),
+                      static_cast<double>(counters[event]));
+        text += item;
+    }
+    return text;
+}
+
+void printCountersJson(std::ostream &out, const HardwareCounters &counters) {
+    out << "{";
+    bool first = true;
+    for (size_t e = 0; e < static_cast<size_t>(HardwareEvent::Count); ++e) {
+        auto event = static_cast<HardwareEvent>(e);
+        if (!counters.has(event)) continue;
+        out << (first ? "" : ", ") << '"' << hardwareEventName(event) << "\": " << counters[event];
+        first = false;
+    }
+    out << "}";
+}
+
+void printText(std::ostream &out, const PipelineStats &stats) {
+    auto ms = [&](StatsPhase phase) { return static_cast<double>(stats.phaseNs[static_cast<size_t>(phase)]) / 1e6; };
+    uint64_t lexNs = stats.phaseNs[static_cast<size_t>(StatsPhase::Lex)];
+    uint64_t parseNs = stats.phaseNs[static_cast<size_t>(StatsPhase::Parse)];
+    char line[256];
+    std::snprintf(line, sizeof line, "Статистика: файлов %llu (из кэша %llu), ошибок %llu\n",
+                  static_cast<unsigned long long>(stats.files), static_cast<unsigned long long>(stats.cacheHits),
+                  static_cast<unsigned long long>(stats.errors));
+    out << line;
+    for (size_t p = 0; p < static_cast<size_t>(StatsPhase::Count); ++p) {
+        if (!stats.phaseNs[p]) continue;
+        std::snprintf(line, sizeof line, "  %-12s %10.3f мс", PHASE_TITLES[p], ms(static_cast<StatsPhase>(p)));
+        out << line;
+        if (stats.phaseCounters[p].valid) out << "; " << describeCounters(stats.phaseCounters[p]);
+        out << "\n";
+    }
+    std::snprintf(line, sizeof line,
+                  "  лексер: токенов %llu, байт %llu, строк %llu, неизвестных символов %llu; "
+                  "%.1f МБ/с, %.2f Мтокенов/с\n",
+                  static_cast<unsigned long long>(stats.lexer.tokens),
+                  static_cast<unsigned long long>(stats.lexer.bytes),
+                  static_cast<unsigned long long>(stats.lexer.lines),
+                  static_cast<unsigned long long>(stats.lexer.unknown), perSecond(stats.lexer.bytes, lexNs) / 1e6,
+                  perSecond(stats.lexer.tokens, lexNs) / 1e6);
+    out << line;
+    std::snprintf(line, sizeof line,
+                  "  парсер: узлов %llu, токенов %llu, ошибок %llu, заглядывание до %zu, глубина до %zu; "
+                  "%.2f Мтокенов/с\n",
+                  static_cast<unsigned long long>(stats.parser.nodes),
+                  static_cast<unsigned long long>(stats.parser.tokens),
+                  static_cast<unsigned long long>(stats.parser.errors), stats.parser.peakLookahead,
+                  stats.parser.maxDepth, perSecond(stats.parser.tokens, parseNs) / 1e6);
+    out << line;
+    if (stats.outputBytes) out << "  вывод: байт " << stats.outputBytes << "\n";
+    for (const PassStats &pass: stats.passes) {
+        std::snprintf(line, sizeof line, "  проход %-8s %10.3f мс", pass.name, static_cast<double>(pass.ns) / 1e6);
+        out << line;
+        if (pass.counters.valid) out << "; " << describeCounters(pass.counters);
+        out << "\n";
+    }
+}
+
+void printJson(std::ostream &out, const PipelineStats &stats) {
+    out << "{\"files\": " << stats.files << ", \"cache_hits\": " << stats.cacheHits << ", \"errors\": "
+        << stats.errors << ", \"phases_ns\": {";
+    for (size_t p = 0; p < static_cast<size_t>(StatsPhase::Count); ++p) {
+        out << (p ? ", " : "") << '"' << statsPhaseName(static_cast<StatsPhase>(p)) << "\": " << stats.phaseNs[p];
+    }
+    out << "}, \"lexer\": {\"tokens\": " << stats.lexer.tokens << ", \"bytes\": " << stats.lexer.bytes
+        << ", \"lines\": " << stats.lexer.lines << ", \"unknown\": " << stats.lexer.unknown
+        << "}, \"parser\": {\"nodes\": " << stats.parser.nodes << ", \"tokens\": " << stats.parser.tokens
+        << ", \"errors\": " << stats.parser.errors << ", \"peak_lookahead\": " << stats.parser.peakLookahead
+        << ", \"max_depth\": " << stats.parser.maxDepth << "}, \"output_bytes\": " << stats.outputBytes;
+    out << ", \"phase_counters\": {";
+    bool first = true;
+    for (size_t p = 0; p < static_cast<size_t>(StatsPhase::Count); ++p) {
+        if (!stats.phaseCounters[p].valid) continue;
+        out << (first ? "" : ", ") << '"' << statsPhaseName(static_cast<StatsPhase>(p)) << "\": ";
+        printCountersJson(out, stats.phaseCounters[p]);
+        first = false;
+    }
+    out << "}, \"passes\": [";
+    for (size_t i = 0; i < stats.passes.size(); ++i) {
+        const PassStats &pass = stats.passes[i];
+        out << (i ? ", " : "") << "{\"name\": \"" << pass.name << "\", \"runs\": " << pass.runs << ", \"ns\": "
+            << pass.ns << ", \"counters\": ";
+        printCountersJson(out, pass.counters);
+        out << "}";
+    }
+    out << "]}\n";
+}
+
+}
+
+void printStats(std::ostream &out, const PipelineStats &stats, bool json) {
+    if (!STATS_ENABLED) {
+        out << "Статистика отключена при сборке (ANALYZER_STATS=OFF)\n";
+        return;
+    }
+    if (json) {
+        printJson(out, stats);
+    } else {
+        printText(out, stats);
+    }
+}
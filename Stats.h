@@ -0,0 +1,136 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "PerfCounters.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Счётчики фронтенда для --stats. Сборка с -DANALYZER_STATS=OFF убирает их
+// полностью: STATS(...) раскрывается в пустоту, таймер фаз пуст. Структуры
+// остаются (с нулями), чтобы интерфейс Lexer, Parser и Driver не зависел от
+// флага.
+#ifdef ANALYZER_STATS
+#define STATS(...) __VA_ARGS__
+constexpr bool STATS_ENABLED = true;
+#else
+#define STATS(...)
+constexpr bool STATS_ENABLED = false;
+#endif
+
+enum class StatsPhase {
+    Read, Cache, Lex, Parse, Analyse, Dump, Run,
+    Count
+};
+
+const char *statsPhaseName(StatsPhase phase);
+
+// Фаза, которую сейчас замеряет PhaseTimer в этом потоке; Count — вне фаз.
+// По ней профиль выделений (AllocProfile.h) делит выделения по фазам.
+inline thread_local StatsPhase activePhase = StatsPhase::Count;
+
+struct LexerStats {
+    uint64_t tokens = 0;
+    uint64_t bytes = 0;
+    uint64_t lines = 0;
+    uint64_t unknown = 0;           // символы вне алфавита (токены UNKNOWN)
+};
+
+struct ParserStats {
+    uint64_t nodes = 0;
+    uint64_t tokens = 0;            // поглощено до конца разбора или ошибки
+    uint64_t errors = 0;
+    size_t peakLookahead = 0;       // дальше всего заглянули за текущий токен
+    size_t maxDepth = 0;            // вложенность операторов и выражений
+};
+
+// Время и счётчики одного прохода (свёртка, SSA, анализ и т. д.).
+struct PassStats {
+    const char *name;
+    uint64_t runs = 0;
+    uint64_t ns = 0;
+    HardwareCounters counters{};
+};
+
+struct PipelineStats {
+    uint64_t phaseNs[static_cast<size_t>(StatsPhase::Count)] = {};
+    // Заполняются, если включены аппаратные счётчики (enablePerfCounters).
+    HardwareCounters phaseCounters[static_cast<size_t>(StatsPhase::Count)];
+    std::vector<PassStats> passes;
+    uint64_t files = 0;
+    uint64_t cacheHits = 0;
+    uint64_t errors = 0;
+    uint64_t outputBytes = 0;
+    LexerStats lexer;               // суммы по файлам
+    ParserStats parser;             // суммы; пики — максимум по файлам
+
+    void add(const LexerStats &stats);
+    void add(const ParserStats &stats);
+};
+
+// Время от создания до разрушения добавляется к фазе (steady_clock), а при
+// включённых аппаратных счётчиках — и их приращение.
+class PhaseTimer {
+public:
+#ifdef ANALYZER_STATS
+    PhaseTimer(PipelineStats &stats, StatsPhase phase)
+            : stats(stats), phase(phase), outer(activePhase), perf(perfCounters()) {
+        activePhase = phase;
+        if (perf) counters = perf->read();
+        start = std::chrono::steady_clock::now();
+    }
+
+    ~PhaseTimer() {
+        auto index = static_cast<size_t>(phase);
+        stats.phaseNs[index] += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        if (perf) stats.phaseCounters[index] += perf->read() - counters;
+        activePhase = outer;
+    }
+#else
+    PhaseTimer(PipelineStats &, StatsPhase) {}
+#endif
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+#ifdef ANALYZER_STATS
+private:
+    PipelineStats &stats;
+    StatsPhase phase;
+    StatsPhase outer;
+    const PerfCounters *perf;
+    HardwareCounters counters;
+    std::chrono::steady_clock::time_point start;
+#endif
+};
+
+// То же для отдельного прохода: результаты копятся в stats.passes по имени
+// (строковый литерал).
+class PassTimer {
+public:
+#ifdef ANALYZER_STATS
+    PassTimer(PipelineStats &stats, const char *name);
+    ~PassTimer();
+#else
+    PassTimer(PipelineStats &, const char *) {}
+#endif
+
+    PassTimer(const PassTimer&) = delete;
+    PassTimer& operator=(const PassTimer&) = delete;
+
+#ifdef ANALYZER_STATS
+private:
+    PipelineStats &stats;
+    const char *name;
+    const PerfCounters *perf;
+    HardwareCounters counters;
+    std::chrono::steady_clock::time_point start;
+#endif
+};
+
+void printStats(std::ostream &out, const PipelineStats &stats, bool json);
+
+#endif
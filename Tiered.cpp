@@ -0,0 +1,65 @@
+#include "Tiered.h"
+
+TieredEngine::TieredEngine(std::istream &in, OutputBuffer &out, const TierConfig &config)
+        : interpreter(in, out), vm(in, out), config(config) {
+    interpreter.setLoopHook([this](const ASTNode &loop, double *frame, uint64_t iteration) {
+        return onLoopHeader(loop, frame, iteration);
+    });
+}
+
+RunStats TieredEngine::run(ASTNode &program) {
+    loops.clear();
+    tierStats = TierStats();
+    return interpreter.run(program);
+}
+
+bool TieredEngine::onLoopHeader(const ASTNode &loop, double *frame, uint64_t iteration) {
+    LoopState &state = loops[&loop];
+    uint64_t executed = interpreter.executedStatements();
+    if (iteration > 0) {
+        // Обратный переход: тело стоило столько операторов (с вложенными).
+        state.hotness += 1 + (executed - state.statementsAtHeader);
+    }
+    state.statementsAtHeader = executed;
+
+    if (state.chunk || state.hotness >= config.bytecodeThreshold) {
+        if (iteration > 0) ++tierStats.osrEntries;
+        return runCompiled(loop, state, frame);
+    }
+    return false;
+}
+
+bool TieredEngine::runCompiled(const ASTNode &loop, LoopState &state, double *frame) {
+    if (!state.chunk) {
+        state.chunk = std::make_unique<Chunk>(compileStatement(loop, interpreter.frame().size()));
+        ++tierStats.loopsInBytecode;
+    }
+    if (state.native) {
+        (*state.native)(frame);
+        return true;
+    }
+
+    bool jit = config.enableJit && !state.nativeRejected && jitSupported();
+    while (true) {
+        uint64_t budget = UINT64_MAX;
+        if (jit) {
+            budget = state.backEdges < config.nativeThreshold ? config.nativeThreshold - state.backEdges : 1;
+        }
+        uint64_t backEdges = 0;
+        bool finished = vm.executeLoop(*state.chunk, frame, budget, backEdges);
+        state.backEdges += backEdges;
+        if (finished) return true;
+
+        // Бюджет исчерпан: VM стоит в заголовке цикла, продолжаем машинным кодом.
+        state.native = compileNative(*state.chunk);
+        if (state.native) {
+            ++tierStats.loopsInNative;
+            ++tierStats.osrEntries;
+            (*state.native)(frame);
+            return true;
+        }
+        state.nativeRejected = true;
+        ++tierStats.nativeRejected;
+        jit = false;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef TIERED_H
+#define TIERED_H
+
+#include "AST.h"
+#include "Bytecode.h"
+#include "Interpreter.h"
+#include "Jit.h"
+#include "OutputBuffer.h"
+#include "VM.h"
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <unordered_map>
+
+struct TierConfig {
+    // Операторов, выполненных внутри цикла интерпретатором AST, до перевода
+    // цикла в байткод.
+    uint64_t bytecodeThreshold = 1000;
+    // Обратных переходов цикла в виртуальной машине до перевода в машинный код.
+    uint64_t nativeThreshold = 10000;
+    bool enableJit = true;
+};
+
+struct TierStats {
+    uint64_t loopsInBytecode = 0;
+    uint64_t loopsInNative = 0;
+    uint64_t nativeRejected = 0;        // циклы, которые JIT не смог перевести
+    uint64_t osrEntries = 0;            // переходов на другой уровень посреди цикла
+};
+
+// Многоуровневое исполнение: программа стартует в интерпретаторе AST, без
+// предварительной компиляции. Для каждого цикла while считаются выполненные
+// в нём операторы и обратные переходы; горячий цикл переводится в байткод,
+// а затем в машинный код. Все уровни работают над одним кадром, поэтому
+// переход (OSR) делается в заголовке цикла, где стек операндов пуст:
+// фрагмент цикла начинается с проверки условия.
+class TieredEngine {
+public:
+    TieredEngine(std::istream &in, OutputBuffer &out, const TierConfig &config = TierConfig());
+
+    RunStats run(ASTNode &program);
+
+    const TierStats &stats() const { return tierStats; }
+
+private:
+    struct LoopState {
+        uint64_t hotness = 0;           // операторы тела в интерпретаторе
+        uint64_t backEdges = 0;         // обратные переходы в VM
+        uint64_t statementsAtHeader = 0;
+        std::unique_ptr<Chunk> chunk;
+        std::unique_ptr<NativeCode> native;
+        bool nativeRejected = false;
+    };
+
+    Interpreter interpreter;
+    VM vm;
+    TierConfig config;
+    TierStats tierStats;
+    std::unordered_map<const ASTNode *, LoopState> loops;
+
+    bool onLoopHeader(const ASTNode &loop, double *frame, uint64_t iteration);
+    bool runCompiled(const ASTNode &loop, LoopState &state, double *frame);
+};
+
+#endif
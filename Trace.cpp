@@ -0,0 +1,145 @@
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct TraceEvent {
+    const char *name;
+    const char *category;
+    char phase;                     // 'X' — отрезок, 'i' — мгновенное
+    uint64_t start;                 // нс от включения трассировки
+    uint64_t duration;
+    std::string detail;
+};
+
+// Буфер одного потока. Пишет только владелец; буферы не освобождаются,
+// чтобы события завершившихся потоков дожили до writeTrace.
+struct ThreadTrace {
+    uint32_t id;
+    std::string name;
+    std::deque<TraceEvent> events;
+    ThreadTrace *next = nullptr;
+};
+
+std::atomic<bool> tracing{false};
+std::atomic<ThreadTrace*> threads{nullptr};
+std::atomic<uint32_t> threadCount{0};
+std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+thread_local ThreadTrace *local = nullptr;
+
+uint64_t now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+}
+
+ThreadTrace &localTrace() {
+    if (!local) {
+        local = new ThreadTrace;
+        local->id = threadCount.fetch_add(1) + 1;
+        local->name = local->id == 1 ? "main" : "thread " + std::to_string(local->id);
+        ThreadTrace *head = threads.load();
+        do {
+            local->next = head;
+        } while (!threads.compare_exchange_weak(head, local));
+    }
+    return *local;
+}
+
+void record(const char *name, const char *category, char phase, uint64_t start, uint64_t duration,
+            const std::string &detail) {
+    localTrace().events.push_back({name, category, phase, start, duration, detail});
+}
+
+void writeString(std::ostream &out, const std::string &text) {
+    out << '"';
+    for (char c: text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof escaped, "\\u%04x", c);
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+}
+
+void enableTracing(bool enabled) {
+    if (enabled && !tracing.load()) epoch = std::chrono::steady_clock::now();
+    tracing = enabled;
+}
+
+bool tracingEnabled() {
+    return tracing.load(std::memory_order_relaxed);
+}
+
+void setTraceThreadName(const std::string &name) {
+    if (tracingEnabled()) localTrace().name = name;
+}
+
+void traceInstant(const char *name, const char *category, const std::string &detail) {
+    if (tracingEnabled()) record(name, category, 'i', now(), 0, detail);
+}
+
+void writeTrace(const std::string &path) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Не удалось открыть файл трассы: " + path);
+    // Время в trace_event — микросекунды; дробная часть сохраняет наносекунды.
+    auto micros = [](uint64_t ns) { return std::to_string(ns / 1000) + "." + std::to_string(ns % 1000 / 100); };
+    long pid = static_cast<long>(getpid());
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "{\"ph\": \"M\", \"name\": \"process_name\", \"pid\": " << pid
+        << ", \"tid\": 0, \"args\": {\"name\": \"syntax_analyzer\"}}";
+    for (ThreadTrace *thread = threads.load(); thread; thread = thread->next) {
+        out << ",\n{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": " << pid << ", \"tid\": " << thread->id
+            << ", \"args\": {\"name\": ";
+        writeString(out, thread->name);
+        out << "}}";
+        for (const TraceEvent &event: thread->events) {
+            out << ",\n{\"ph\": \"" << event.phase << "\", \"name\": \"" << event.name << "\", \"cat\": \""
+                << event.category << "\", \"pid\": " << pid << ", \"tid\": " << thread->id
+                << ", \"ts\": " << micros(event.start);
+            if (event.phase == 'X') out << ", \"dur\": " << micros(event.duration);
+            if (event.phase == 'i') out << ", \"s\": \"t\"";
+            if (!event.detail.empty()) {
+                out << ", \"args\": {\"detail\": ";
+                writeString(out, event.detail);
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    if (!out) throw std::runtime_error("Ошибка записи файла трассы: " + path);
+}
+
+TraceSpan::TraceSpan(const char *name, const char *category, const std::string &detail)
+        : name(name), category(category), active(tracingEnabled()) {
+    if (!active) return;
+    this->detail = detail;
+    start = now();
+}
+
+TraceSpan::~TraceSpan() {
+    if (active) record(name, category, 'X', start, now() - start, detail);
+}
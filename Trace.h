@@ -0,0 +1,44 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+
+// Трассировка в формате Chrome trace_event (JSON открывается в Perfetto и
+// chrome://tracing). У каждого потока свой буфер событий: запись идёт без
+// блокировок и атомарных операций, общий список буферов пополняется один
+// раз на поток (CAS). Пока трассировка не включена, TraceSpan — одна
+// проверка флага.
+
+void enableTracing(bool enabled);
+bool tracingEnabled();
+
+// Имя текущего потока в трассе (по умолчанию «thread N»).
+void setTraceThreadName(const std::string &name);
+
+// Мгновенное событие: попадание в кэш, ошибка и т. п.
+void traceInstant(const char *name, const char *category, const std::string &detail = "");
+
+// Пишет все события в файл. Вызывать после завершения рабочих потоков:
+// их буферы читаются без синхронизации.
+void writeTrace(const std::string &path);
+
+// Отрезок времени от создания до разрушения. name и category — строковые
+// литералы (хранится указатель), detail копируется.
+class TraceSpan {
+public:
+    TraceSpan(const char *name, const char *category, const std::string &detail = "");
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char *name;
+    const char *category;
+    std::string detail;
+    uint64_t start = 0;
+    bool active;
+};
+
+#endif
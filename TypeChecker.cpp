@@ -0,0 +1,233 @@
+#include "TypeChecker.h"
+#include "AstVisitor.h"
+#include <algorithm>
+#include <stdexcept>
+
+const char *valueTypeName(ValueType type) {
+    switch (type) {
+        case ValueType::Unknown: return "unknown";
+        case ValueType::Boolean: return "boolean";
+        case ValueType::Integer: return "integer";
+        case ValueType::Real: return "real";
+        case ValueType::String: return "string";
+    }
+    return "?";
+}
+
+bool parseTypeName(const std::string &name, ValueType &type) {
+    if (name == "real") type = ValueType::Real;
+    else if (name == "integer") type = ValueType::Integer;
+    else if (name == "boolean") type = ValueType::Boolean;
+    else return false;
+    return true;
+}
+
+ValueType literalType(const ASTNode &number) {
+    if (number.valueType != ValueType::Unknown) return number.valueType;
+    return number.value.find_first_of(".eE") == std::string::npos ? ValueType::Integer : ValueType::Real;
+}
+
+namespace {
+
+bool isNumeric(ValueType type) {
+    return type == ValueType::Boolean || type == ValueType::Integer || type == ValueType::Real;
+}
+
+}
+
+ValueType binaryResultType(BinaryOp op, ValueType left, ValueType right) {
+    if (!isNumeric(left) || !isNumeric(right)) return ValueType::Unknown;
+    switch (op) {
+        case BinaryOp::Lt:
+        case BinaryOp::Gt:
+        case BinaryOp::Le:
+        case BinaryOp::Ge:
+        case BinaryOp::Eq:
+        case BinaryOp::Ne:
+            return ValueType::Boolean;
+        case BinaryOp::Div:
+            return ValueType::Real;
+        case BinaryOp::Invalid:
+            return ValueType::Unknown;
+        default:
+            return std::max({left, right, ValueType::Integer});
+    }
+}
+
+ValueType builtinResultType(const Builtin &builtin, ValueType argument) {
+    if (!isNumeric(argument)) return ValueType::Unknown;
+    return builtin.keepsInteger && argument != ValueType::Real ? ValueType::Integer : ValueType::Real;
+}
+
+bool assignable(ValueType to, ValueType from) {
+    // Unknown — уже сообщённая ошибка, повторно о ней не говорим.
+    if (to == ValueType::Unknown || from == ValueType::Unknown) return true;
+    return isNumeric(to) && isNumeric(from) && from <= to;
+}
+
+namespace {
+
+class TypeChecker : public AstVisitor<TypeChecker> {
+public:
+    std::vector<std::string> diagnostics;
+
+    explicit TypeChecker(Resolution &resolution) : slotTypes(resolution.slotTypes) {
+        slotTypes.assign(resolution.frameSize, ValueType::Unknown);
+        constants.assign(resolution.frameSize, 0);
+    }
+
+    void leaveConstDecl(ASTNode &node) {
+        if (node.slot < 0 || node.children.size() != 1) return;
+        node.valueType = node.children[0]->valueType;
+        slotTypes[node.slot] = node.valueType;
+        constants[node.slot] = 1;
+    }
+
+    void leaveVarDecl(ASTNode &node) {
+        ValueType declared = ValueType::Unknown;
+        size_t colon = node.value.find(" : ");
+        if (colon != std::string::npos) {
+            std::string name = node.value.substr(colon + 3);
+            if (!parseTypeName(name, declared)) error("Неизвестный тип: " + name);
+        }
+
+        // Объявления проходов ('$' в имени) обязаны нести тип, см. TypeChecker.h.
+        if (colon == std::string::npos && node.value.find('$') != std::string::npos) {
+            error("Объявление прохода без типа: " + node.value);
+        }
+
+        ValueType type = declared;
+        if (!node.children.empty()) {
+            ValueType initializer = node.children[0]->valueType;
+            if (declared == ValueType::Unknown) {
+                // Без аннотации числовая переменная — real, как и без
+                // инициализатора: var s := 0 — обычный накопитель для s + 0.5.
+                type = isNumeric(initializer) ? ValueType::Real : initializer;
+                if (type == ValueType::String) error("Строковые переменные не поддерживаются: " + node.value);
+            } else if (!assignable(declared, initializer)) {
+                error("Нельзя инициализировать " + node.value + " значением типа " +
+                      valueTypeName(initializer));
+            }
+        } else if (type == ValueType::Unknown) {
+            type = ValueType::Real;
+        }
+
+        node.valueType = type;
+        if (node.slot < 0) return;
+        size_t count = declaredNames(node).size();
+        for (size_t i = 0; i < count; ++i) {
+            slotTypes[node.slot + i] = type;
+        }
+    }
+
+    void leaveAssignment(ASTNode &node) {
+        if (node.slot < 0 || node.children.empty()) return;
+        ValueType target = slotTypes[node.slot];
+        ValueType value = node.children[0]->valueType;
+        if (constants[node.slot]) {
+            error("Нельзя присвоить значение константе " + node.value);
+        } else if (!assignable(target, value)) {
+            error("Нельзя присвоить значение типа " + std::string(valueTypeName(value)) +
+                  " переменной " + node.value + " типа " + valueTypeName(target));
+        }
+        node.valueType = target;
+    }
+
+    void leaveIfStatement(ASTNode &node) { checkCondition(node); }
+
+    void leaveWhileStatement(ASTNode &node) { checkCondition(node); }
+
+    void leaveProcedureCall(ASTNode &node) {
+        if (node.slot < 0) return;
+        switch (static_cast<Procedure>(node.slot)) {
+            case Procedure::Write:
+            case Procedure::Writeln:
+                return;
+            case Procedure::Readln:
+                for (const auto &arg: node.children) {
+                    ValueType type = arg->valueType;
+                    if (arg->slot >= 0 && constants[arg->slot]) {
+                        error("readln не читает в константу " + arg->value);
+                    } else if (type != ValueType::Integer && type != ValueType::Real && type != ValueType::Unknown) {
+                        error("readln не читает в переменную " + arg->value + " типа " + valueTypeName(type));
+                    }
+                }
+                return;
+            case Procedure::Assert:
+                for (const auto &arg: node.children) {
+                    expectNumeric(*arg, "Аргумент assert");
+                }
+                return;
+        }
+    }
+
+    void leaveFactor(ASTNode &node) {
+        switch (node.factor) {
+            case FactorKind::Number:
+                node.valueType = literalType(node);
+                break;
+            case FactorKind::String:
+                node.valueType = ValueType::String;
+                break;
+            case FactorKind::Name:
+                if (node.slot >= 0) node.valueType = slotTypes[node.slot];
+                break;
+            case FactorKind::Call:
+                if (node.slot >= 0 && node.children.size() == 1) {
+                    const ASTNode &argument = *node.children[0];
+                    expectNumeric(argument, std::string("Аргумент ") + node.value);
+                    node.valueType = builtinResultType(BUILTINS[node.slot], argument.valueType);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    void leaveExpression(ASTNode &node) { binary(node); }
+
+    void leaveTerm(ASTNode &node) { binary(node); }
+
+private:
+    std::vector<ValueType> &slotTypes;
+    std::vector<uint8_t> constants;     // ячейки констант: не пишутся ни присваиванием, ни readln
+
+    void error(std::string message) { diagnostics.push_back(std::move(message)); }
+
+    void expectNumeric(const ASTNode &node, const std::string &what) {
+        if (node.valueType != ValueType::Unknown && !isNumeric(node.valueType)) {
+            error(what + ": ожидалось число, получено " + valueTypeName(node.valueType));
+        }
+    }
+
+    void checkCondition(const ASTNode &node) {
+        if (!node.children.empty()) expectNumeric(*node.children[0], "Условие");
+    }
+
+    void binary(ASTNode &node) {
+        if (node.children.size() == 1) {
+            node.valueType = node.children[0]->valueType;
+            return;
+        }
+        if (node.children.size() != 2) return;
+        const ASTNode &left = *node.children[0];
+        const ASTNode &right = *node.children[1];
+        expectNumeric(left, "Операнд " + node.value);
+        expectNumeric(right, "Операнд " + node.value);
+        node.valueType = binaryResultType(binaryOp(node.value), left.valueType, right.valueType);
+    }
+};
+
+}
+
+void checkTypes(ASTNode &program, Resolution &resolution) {
+    TypeChecker checker(resolution);
+    checker.traverse(program);
+    if (!checker.diagnostics.empty()) {
+        std::string message = checker.diagnostics[0];
+        for (size_t i = 1; i < checker.diagnostics.size(); ++i) {
+            message += "\n" + checker.diagnostics[i];
+        }
+        throw std::runtime_error(message);
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef TYPECHECKER_H
+#define TYPECHECKER_H
+
+#include "AST.h"
+#include "Builtins.h"
+#include "Resolver.h"
+#include <string>
+
+const char *valueTypeName(ValueType type);
+
+// Имя типа в объявлении var: real, integer, boolean.
+bool parseTypeName(const std::string &name, ValueType &type);
+
+// Тип числового литерала: ранее выведенный (у свёрнутых литералов) либо по
+// записи — integer без точки и экспоненты, иначе real.
+ValueType literalType(const ASTNode &number);
+
+// Тип результата операции над числами: сравнения — boolean, деление — real,
+// остальное — наибольший из типов операндов, но не уже integer.
+ValueType binaryResultType(BinaryOp op, ValueType left, ValueType right);
+
+ValueType builtinResultType(const Builtin &builtin, ValueType argument);
+
+// Допустимо ли присвоить значение типа from переменной типа to: только
+// расширение boolean -> integer -> real.
+bool assignable(ValueType to, ValueType from);
+
+// Проверка типов разрешённой программы. Переменные без аннотации — real
+// (integer и boolean — только явно объявленные), строковый инициализатор —
+// ошибка. Поэтому объявления, которые синтезируют проходы (имена с '$':
+// licm$N, cse$N), всегда несут явный тип — тип сохраняемого выражения;
+// объявление прохода без типа — ошибка. Проверяются операнды операторов, аргументы встроенных функций и
+// процедур (readln читает только в integer/real, в integer — только целые
+// числа, это проверяют исполнители; строки — только в write/writeln),
+// присваивания и инициализаторы; константу не пишут ни присваивание, ни readln. Типы записываются в ASTNode::valueType, типы
+// ячеек кадра — в resolution.slotTypes. Ошибки собираются и выдаются одним
+// std::runtime_error. После проверки каждое значение программы — число без
+// тега типа, что и позволяет исполнителям работать с голыми double.
+void checkTypes(ASTNode &program, Resolution &resolution);
+
+#endif
@@ -0,0 +1,282 @@
+#include "VM.h"
+#include "Builtins.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__GNUC__) && !defined(SA_NO_COMPUTED_GOTO)
+#define SA_COMPUTED_GOTO 1
+#endif
+
+VM::VM(std::istream &in, OutputBuffer &out) : in(in), out(out) {}
+
+double VM::readNumber(bool integer) {
+    out.flush();
+    double value;
+    if (!(in >> value)) {
+        throw std::runtime_error("Ожидалось число при вводе");
+    }
+    if (integer && value != std::trunc(value)) {
+        throw std::runtime_error("Ожидалось целое число при вводе");
+    }
+    return value;
+}
+
+void VM::execute(const Chunk &chunk, double *frame) {
+    if (stack.size() < chunk.maxStack + 1) stack.resize(chunk.maxStack + 1);
+    budget = INT64_MAX;
+    if (profiling) {
+        dispatch<true>(chunk, frame, UINT32_MAX);
+    } else {
+        dispatch<false>(chunk, frame, UINT32_MAX);
+    }
+}
+
+bool VM::executeLoop(const Chunk &chunk, double *frame, uint64_t limit, uint64_t &backEdges) {
+    if (stack.size() < chunk.maxStack + 1) stack.resize(chunk.maxStack + 1);
+    auto start = static_cast<int64_t>(std::min<uint64_t>(limit, INT64_MAX));
+    budget = start;
+    bool finished = profiling ? dispatch<true>(chunk, frame, chunk.loopBody)
+                              : dispatch<false>(chunk, frame, chunk.loopBody);
+    backEdges = static_cast<uint64_t>(start - budget);
+    return finished;
+}
+
+template <bool Profile>
+bool VM::dispatch(const Chunk &chunk, double *frame, uint32_t exitTarget) {
+    const Instruction *code = chunk.code.data();
+    const Instruction *ip = code;
+    const double *constants = chunk.constants.data();
+    // sp указывает на вершину стека; stack[0] не используется.
+    double *sp = stack.data();
+    size_t previous = OPCODE_COUNT;
+
+    // Знак NaN из двух NaN-операндов не гарантирован: компилятор вправе
+    // переставить операнды + и *, а JIT выбирает порядок сам. Поэтому
+    // OutputBuffer печатает любой NaN одинаково.
+#define BINARY(expr)         \
+    do {                     \
+        double r = *sp--;    \
+        double l = *sp;      \
+        *sp = (expr);        \
+    } while (0)
+
+#ifdef SA_COMPUTED_GOTO
+    static void *const labels[] = {
+            &&op_PushConst, &&op_Load, &&op_Store,
+            &&op_Add, &&op_Sub, &&op_Mul, &&op_Div,
+            &&op_Lt, &&op_Gt, &&op_Le, &&op_Ge, &&op_Eq, &&op_Ne,
+            &&op_CallBuiltin, &&op_Jump, &&op_JumpIfFalse, &&op_JumpIfTrue,
+            &&op_WriteNumber, &&op_WriteString, &&op_Newline, &&op_Read,
+            &&op_Assert, &&op_Halt,
+            &&op_LoadLoad, &&op_LoadLoadAdd, &&op_LoadLoadSub, &&op_LoadLoadMul,
+            &&op_StoreLoad, &&op_Move,
+            &&op_AddConst, &&op_SubConst, &&op_MulConst, &&op_DivConst,
+            &&op_CmpJumpIfFalse, &&op_CmpJumpIfTrue, &&op_IncSlot,
+    };
+    static_assert(sizeof labels / sizeof labels[0] == static_cast<size_t>(OpCode::Count));
+#define CASE(name) op_##name:
+#define NEXT()                                                             \
+    do {                                                                   \
+        if constexpr (Profile) count(previous, ip->op);                    \
+        goto *labels[static_cast<size_t>(ip->op)];                         \
+    } while (0)
+    NEXT();
+#else
+#define CASE(name) case OpCode::name:
+#define NEXT() break
+    for (;;) {
+        if constexpr (Profile) count(previous, ip->op);
+        switch (ip->op) {
+#endif
+
+    CASE(PushConst)
+        *++sp = constants[ip->a];
+        ++ip;
+        NEXT();
+    CASE(Load)
+        *++sp = frame[ip->a];
+        ++ip;
+        NEXT();
+    CASE(Store)
+        frame[ip->a] = *sp--;
+        ++ip;
+        NEXT();
+    CASE(Add)
+        BINARY(l + r);
+        ++ip;
+        NEXT();
+    CASE(Sub)
+        BINARY(l - r);
+        ++ip;
+        NEXT();
+    CASE(Mul)
+        BINARY(l * r);
+        ++ip;
+        NEXT();
+    CASE(Div)
+        BINARY(l / r);
+        ++ip;
+        NEXT();
+    CASE(Lt)
+        BINARY(l < r);
+        ++ip;
+        NEXT();
+    CASE(Gt)
+        BINARY(l > r);
+        ++ip;
+        NEXT();
+    CASE(Le)
+        BINARY(l <= r);
+        ++ip;
+        NEXT();
+    CASE(Ge)
+        BINARY(l >= r);
+        ++ip;
+        NEXT();
+    CASE(Eq)
+        BINARY(l == r);
+        ++ip;
+        NEXT();
+    CASE(Ne)
+        BINARY(l != r);
+        ++ip;
+        NEXT();
+    CASE(CallBuiltin)
+        *sp = BUILTINS[ip->a].fn(*sp);
+        ++ip;
+        NEXT();
+    CASE(Jump)
+        ip = code + ip->a;
+        NEXT();
+    CASE(JumpIfFalse)
+        ip = *sp-- == 0.0 ? code + ip->a : ip + 1;
+        NEXT();
+    CASE(JumpIfTrue)
+        if (*sp-- != 0.0) {
+            // Обратный переход: расходуем бюджет, выходим только в заголовке
+            // внешнего цикла, где стек операндов пуст.
+            if (--budget <= 0 && ip->a == exitTarget) return false;
+            ip = code + ip->a;
+        } else {
+            ++ip;
+        }
+        NEXT();
+    CASE(WriteNumber)
+        out.number(*sp--);
+        ++ip;
+        NEXT();
+    CASE(WriteString)
+        out.append(chunk.strings[ip->a]);
+        ++ip;
+        NEXT();
+    CASE(Newline)
+        out.put('\n');
+        ++ip;
+        NEXT();
+    CASE(Read)
+        frame[ip->a] = readNumber(ip->b != 0);
+        ++ip;
+        NEXT();
+    CASE(Assert)
+        if (*sp-- == 0.0) {
+            throw std::runtime_error("Нарушено утверждение assert");
+        }
+        ++ip;
+        NEXT();
+    CASE(Halt)
+        return true;
+    CASE(LoadLoad)
+        sp[1] = frame[ip->a];
+        sp[2] = frame[ip->b];
+        sp += 2;
+        ++ip;
+        NEXT();
+    CASE(LoadLoadAdd)
+        *++sp = frame[ip->a] + frame[ip->b];
+        ++ip;
+        NEXT();
+    CASE(LoadLoadSub)
+        *++sp = frame[ip->a] - frame[ip->b];
+        ++ip;
+        NEXT();
+    CASE(LoadLoadMul)
+        *++sp = frame[ip->a] * frame[ip->b];
+        ++ip;
+        NEXT();
+    CASE(StoreLoad)
+        frame[ip->a] = *sp;
+        *sp = frame[ip->b];
+        ++ip;
+        NEXT();
+    CASE(Move)
+        frame[ip->b] = frame[ip->a];
+        ++ip;
+        NEXT();
+    CASE(AddConst)
+        *sp += constants[ip->a];
+        ++ip;
+        NEXT();
+    CASE(SubConst)
+        *sp -= constants[ip->a];
+        ++ip;
+        NEXT();
+    CASE(MulConst)
+        *sp *= constants[ip->a];
+        ++ip;
+        NEXT();
+    CASE(DivConst)
+        *sp /= constants[ip->a];
+        ++ip;
+        NEXT();
+    CASE(CmpJumpIfFalse)
+        sp -= 2;
+        ip = applyBinary(static_cast<BinaryOp>(ip->b), sp[1], sp[2]) == 0.0 ? code + ip->a : ip + 1;
+        NEXT();
+    CASE(CmpJumpIfTrue)
+        sp -= 2;
+        if (applyBinary(static_cast<BinaryOp>(ip->b), sp[1], sp[2]) != 0.0) {
+            if (--budget <= 0 && ip->a == exitTarget) return false;
+            ip = code + ip->a;
+        } else {
+            ++ip;
+        }
+        NEXT();
+    CASE(IncSlot)
+        frame[ip->a] += constants[ip->b];
+        ++ip;
+        NEXT();
+
+#ifndef SA_COMPUTED_GOTO
+            case OpCode::Count:
+                return true;
+        }
+    }
+#endif
+
+#undef CASE
+#undef NEXT
+#undef BINARY
+}
+
+RunStats VM::run(ASTNode &program) {
+    using Clock = std::chrono::steady_clock;
+    RunStats stats;
+
+    auto start = Clock::now();
+    Chunk chunk = compileProgram(program, superinstructions);
+    slots = chunk.initialFrame;
+    auto compiled = Clock::now();
+
+    instructions = 0;
+    execute(chunk, slots.data());
+    out.flush();
+    auto finished = Clock::now();
+
+    stats.resolveMs = std::chrono::duration<double, std::milli>(compiled - start).count();
+    stats.executeMs = std::chrono::duration<double, std::milli>(finished - compiled).count();
+    // Команды считает только dispatch<true>; без профилирования счётчика нет.
+    if (profiling) stats.statements = instructions;
+    return stats;
+}
@@ -0,0 +1,77 @@
+#ifndef VM_H
+#define VM_H
+
+#include "AST.h"
+#include "Bytecode.h"
+#include "Interpreter.h"
+#include "OutputBuffer.h"
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+// Стековая виртуальная машина для байткода. При сборке GCC/Clang цикл
+// выборки команд — шитый код на computed goto, иначе (или с
+// SA_NO_COMPUTED_GOTO) — переносимый switch.
+class VM {
+public:
+    static constexpr size_t OPCODE_COUNT = static_cast<size_t>(OpCode::Count);
+
+    VM(std::istream &in, OutputBuffer &out);
+
+    // Выполняет фрагмент над внешним кадром: кадр может принадлежать
+    // другому исполнителю (переход между уровнями исполнения).
+    void execute(const Chunk &chunk, double *frame);
+
+    // Выполняет фрагмент-цикл, пока не будет сделано budget обратных
+    // переходов. При исчерпании останавливается в заголовке внешнего цикла и
+    // возвращает false: повторный вход с начала фрагмента (любым
+    // исполнителем) продолжает цикл. backEdges — сделано обратных переходов.
+    bool executeLoop(const Chunk &chunk, double *frame, uint64_t budget, uint64_t &backEdges);
+
+    // Компилирует и выполняет программу; statements — число выполненных
+    // команд, только в режиме профилирования (setProfiling), иначе 0.
+    RunStats run(ASTNode &program);
+
+    // Компилировать ли программу в run() с суперинструкциями.
+    void setSuperinstructions(bool enabled) { superinstructions = enabled; }
+
+    // Режим профилирования: подсчёт выполненных команд и пар подряд
+    // выполненных команд (по ним выбираются суперинструкции).
+    void setProfiling(bool enabled) { profiling = enabled; }
+    uint64_t executedInstructions() const { return instructions; }
+    const std::array<uint64_t, OPCODE_COUNT> &opcodeCounts() const { return opcodes; }
+    uint64_t pairCount(OpCode first, OpCode second) const {
+        return pairs[static_cast<size_t>(first) * OPCODE_COUNT + static_cast<size_t>(second)];
+    }
+
+    const std::vector<double> &frame() const { return slots; }
+
+private:
+    std::istream &in;
+    OutputBuffer &out;
+    std::vector<double> slots;
+    std::vector<double> stack;
+    bool profiling = false;
+    bool superinstructions = true;
+    uint64_t instructions = 0;
+    int64_t budget = 0;
+    std::array<uint64_t, OPCODE_COUNT> opcodes{};
+    // Строка OPCODE_COUNT — «начало фрагмента», у первой команды нет пары.
+    std::vector<uint64_t> pairs = std::vector<uint64_t>((OPCODE_COUNT + 1) * OPCODE_COUNT);
+
+    void count(size_t &previous, OpCode op) {
+        auto current = static_cast<size_t>(op);
+        ++instructions;
+        ++opcodes[current];
+        ++pairs[previous * OPCODE_COUNT + current];
+        previous = current;
+    }
+
+    template <bool Profile>
+    bool dispatch(const Chunk &chunk, double *frame, uint32_t exitTarget);
+
+    double readNumber(bool integer);
+};
+
+#endif
@@ -1,13 +1,169 @@
 #include "Lexer.h"
 #include "Parser.h"
 #include "AST.h"
+#include "Driver.h"
+#include "AstDumper.h"
+#include "OutputBuffer.h"
+#include "ConstFold.h"
+#include "Interpreter.h"
+#include "VM.h"
+#include "Jit.h"
+#include "Tiered.h"
+#include "TypeChecker.h"
+#include "Cfg.h"
+#include "Dataflow.h"
+#include "Ssa.h"
+#include "Licm.h"
+#include "Cse.h"
+#include "ExprDag.h"
+#include "Stats.h"
+#include "AllocProfile.h"
+#include "Trace.h"
+#include "PerfCounters.h"
+#include "RuleProfile.h"
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <vector>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
-int main() {
+// Граф потока управления и анализы потока данных; предупреждения — в stderr.
+static void analyzeProgram(ASTNode &program) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    Resolution resolution = resolveNames(program);
+    checkTypes(program, resolution);
+    Cfg cfg = buildCfg(program, resolution.frameSize);
+    auto built = Clock::now();
+    DataflowResult live = liveVariables(cfg);
+    DataflowResult assigned = definitelyAssigned(cfg);
+    auto solved = Clock::now();
+    Dominators dominators = buildDominators(cfg);
+    ReachingDefinitions reaching = reachingDefinitions(cfg, dominators, live);
+    auto chained = Clock::now();
+
+    for (const auto &warning: dataflowWarnings(cfg, live, assigned)) {
+        std::cerr << "Предупреждение: " << warning << std::endl;
+    }
+    std::cerr << "Блоков: " << cfg.blocks.size() << ", операторов: " << cfg.statements.size()
+              << ", слияний определений: " << reaching.merges.size()
+              << ", посещений блоков: " << live.visits + assigned.visits
+              << "; семантика и граф: " << std::chrono::duration<double, std::milli>(built - start).count()
+              << " мс, живость и присваивания: " << std::chrono::duration<double, std::milli>(solved - built).count()
+              << " мс, достигающие определения: " << std::chrono::duration<double, std::milli>(chained - solved).count()
+              << " мс" << std::endl;
+}
+
+static void dumpResult(OutputBuffer &out, const ParseResult &result, DumpFormat format) {
+    if (format == DumpFormat::Text) {
+        out.append("Лексический анализ завершён. Токены:\n");
+        dumpTokens(out, result.tokens, format);
+        out.append("-----------------------\n");
+        out.append("Дерево разбора:\n");
+    } else {
+        dumpTokens(out, result.tokens, format);
+    }
+    dumpAst(out, *result.ast, format);
+}
+
+int main(int argc, char *argv[]) {
+#ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
+#endif
+
+    // syntax_analyzer [--cache-dir DIR] [--cache-limit-mb N] [--format text|json|sexpr]
+    //                 [--fold] [--ssa] [--licm] [--cse] [--analyze] [--run] [--engine tiered|ast|vm|jit]
+    //                 [--tier-bytecode N] [--tier-native N] [--stats[=text|json]]
+    //                 [--alloc-stats[=text|json]] [--trace файл.json] [--perf-counters]
+    //                 [--rule-profile[=text|json]] [файлы...]
+    DriverOptions options;
+    DumpFormat format = DumpFormat::Text;
+    bool fold = false;
+    bool ssa = false;
+    bool licm = false;
+    bool cse = false;
+    bool run = false;
+    bool analyze = false;
+    bool showStats = false;
+    bool statsJson = false;
+    bool allocStats = false;
+    bool allocJson = false;
+    std::string tracePath;
+    bool hardwareCounters = false;
+    bool ruleProfile = false;
+    bool ruleJson = false;
+    std::string engine = "tiered";
+    TierConfig tiers;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            if (!parseDumpFormat(argv[++i], format)) {
+                std::cerr << "Неизвестный формат вывода: " << argv[i] << std::endl;
+                return 2;
+            }
+        } else if (arg == "--fold") {
+            fold = true;
+        } else if (arg == "--ssa") {
+            ssa = true;
+        } else if (arg == "--licm") {
+            licm = true;
+        } else if (arg == "--cse") {
+            cse = true;
+        } else if (arg == "--analyze") {
+            analyze = true;
+        } else if (arg == "--stats" || arg == "--stats=text" || arg == "--stats=json") {
+            showStats = true;
+            statsJson = arg == "--stats=json";
+        } else if (arg == "--alloc-stats" || arg == "--alloc-stats=text" || arg == "--alloc-stats=json") {
+            allocStats = true;
+            allocJson = arg == "--alloc-stats=json";
+        } else if (arg == "--perf-counters") {
+            // Счётчики печатаются в статистике фаз.
+            hardwareCounters = true;
+            showStats = true;
+        } else if (arg == "--rule-profile" || arg == "--rule-profile=text" || arg == "--rule-profile=json") {
+#ifndef ANALYZER_RULE_PROFILE
+            std::cerr << "Профиль правил не собран: нужна сборка с -DANALYZER_RULE_PROFILE=ON" << std::endl;
+            return 2;
+#endif
+            ruleProfile = true;
+            ruleJson = arg == "--rule-profile=json";
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--run") {
+            run = true;
+        } else if (arg == "--engine" && i + 1 < argc) {
+            engine = argv[++i];
+            if (engine != "tiered" && engine != "ast" && engine != "vm" && engine != "jit") {
+                std::cerr << "Неизвестный исполнитель: " << engine << std::endl;
+                return 2;
+            }
+        } else if (arg == "--tier-bytecode" && i + 1 < argc) {
+            tiers.bytecodeThreshold = std::stoull(argv[++i]);
+        } else if (arg == "--tier-native" && i + 1 < argc) {
+            tiers.nativeThreshold = std::stoull(argv[++i]);
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            options.cacheDir = argv[++i];
+        } else if (arg == "--cache-limit-mb" && i + 1 < argc) {
+            options.cacheLimitBytes = std::stoull(argv[++i]) << 20;
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    enableAllocProfile(allocStats);
+    enableTracing(!tracePath.empty());
+    if (hardwareCounters) {
+        enablePerfCounters(true);
+        if (!perfCounters()->unavailableReason().empty()) {
+            std::cerr << "Часть аппаратных счётчиков недоступна (" << perfCounters()->unavailableReason() << ")"
+                      << std::endl;
+        }
+    }
+
     std::string inputCode = R"(
 const eps = 0.0001;
 var a,b: real;
@@ -37,30 +193,120 @@ begin
 end.
     )";
 
-    // Можно также читать из файла:
-    // std::ifstream inFile("input.txt");
-    // std::stringstream buffer;
-    // buffer << inFile.rdbuf();
-    // std::string inputCode = buffer.str();
-
-    Lexer lexer(inputCode);
-    std::vector<Token> tokens = lexer.tokenize();
-
-    std::cout << "Лексический анализ завершён. Токены:" << std::endl;
-    for (const auto &token: tokens) {
-        std::cout << token.lexeme << " ";
-    }
-    std::cout << std::endl << "-----------------------" << std::endl;
-
+    int status = 0;
     try {
-        Parser parser(tokens);
-        std::shared_ptr<ASTNode> ast = parser.parse();
-
-        std::cout << "Дерево разбора:" << std::endl;
-        ast->print();
+        OutputBuffer out;
+        Driver driver(options);
+        auto handle = [&](ParseResult result) {
+            {
+                PhaseTimer timer(driver.stats(), StatsPhase::Analyse);
+                TraceSpan span("analyse", "passes");
+                if (fold) {
+                    PassTimer pass(driver.stats(), "fold");
+                    foldConstants(result.ast);
+                }
+                if (ssa) {
+                    PassTimer pass(driver.stats(), "ssa");
+                    SsaStats stats = optimizeSsa(result.ast);
+                    out.flush();
+                    std::cerr << "SSA: подставлено констант: " << stats.constants << ", копий: " << stats.copies
+                              << ", убрано ветвлений: " << stats.prunedBranches
+                              << ", мёртвых присваиваний: " << stats.deadStores << std::endl;
+                }
+                if (licm) {
+                    PassTimer pass(driver.stats(), "licm");
+                    LicmStats stats = hoistLoopInvariants(result.ast);
+                    out.flush();
+                    std::cerr << "LICM: вынесено выражений: " << stats.hoisted << " из циклов: " << stats.loops
+                              << ", повторных использований: " << stats.reused << std::endl;
+                }
+                if (cse) {
+                    PassTimer pass(driver.stats(), "cse");
+                    CseStats stats = eliminateCommonSubexpressions(result.ast);
+                    // Склейка последней: проходы выше хранят данные по адресам узлов.
+                    DagStats dag = shareExpressions(result.ast);
+                    out.flush();
+                    std::cerr << "CSE: повторяющихся выражений: " << stats.candidates << ", вычислений заменено: "
+                              << stats.reused << ", временных: " << stats.temporaries
+                              << (stats.global ? "" : " (только внутри базовых блоков)")
+                              << "; узлов выражений: " << dag.nodes << " -> " << dag.unique << std::endl;
+                }
+                if (analyze) {
+                    PassTimer pass(driver.stats(), "analyze");
+                    out.flush();
+                    analyzeProgram(*result.ast);
+                }
+            }
+            if (!run) {
+                if (analyze) return;
+                PhaseTimer timer(driver.stats(), StatsPhase::Dump);
+                TraceSpan span("dump", "output");
+                dumpResult(out, result, format);
+                return;
+            }
+            PhaseTimer timer(driver.stats(), StatsPhase::Run);
+            TraceSpan span("run", "engine");
+            if (engine == "tiered") {
+                TieredEngine tiered(std::cin, out, tiers);
+                RunStats stats = tiered.run(*result.ast);
+                const TierStats &promoted = tiered.stats();
+                std::cerr << "Разрешение имён: " << stats.resolveMs << " мс, выполнение: "
+                          << stats.executeMs << " мс; циклов в байткоде: " << promoted.loopsInBytecode
+                          << ", в машинном коде: " << promoted.loopsInNative
+                          << ", переходов OSR: " << promoted.osrEntries << std::endl;
+            } else if (engine == "ast") {
+                RunStats stats = Interpreter(std::cin, out).run(*result.ast);
+                std::cerr << "Разрешение имён: " << stats.resolveMs << " мс, выполнение: "
+                          << stats.executeMs << " мс, операторов: " << stats.statements << std::endl;
+            } else if (engine == "jit") {
+                RunStats stats = runWithJit(*result.ast, std::cin, out);
+                std::cerr << "Разрешение имён: " << stats.resolveMs << " мс, выполнение с JIT: "
+                          << stats.executeMs << " мс" << std::endl;
+            } else {
+                RunStats stats = VM(std::cin, out).run(*result.ast);
+                std::cerr << "Компиляция в байткод: " << stats.resolveMs << " мс, выполнение: "
+                          << stats.executeMs << " мс" << std::endl;
+            }
+        };
+        if (files.empty()) {
+            handle(driver.parseSource(inputCode));
+        }
+        for (const auto &file: files) {
+            try {
+                ParseResult result = driver.parseFile(file);
+                if (format == DumpFormat::Text && !run && !analyze) {
+                    out.append("== ");
+                    out.append(file);
+                    out.append(result.fromCache ? " (из кэша)\n" : "\n");
+                }
+                handle(std::move(result));
+            } catch (std::exception &ex) {
+                out.flush();
+                std::cerr << file << ": Ошибка: " << ex.what() << std::endl;
+                STATS(++driver.stats().errors;)
+                status = 1;
+            }
+        }
+        if (showStats) {
+            out.flush();
+            driver.stats().outputBytes = out.bytesWritten();
+            printStats(std::cerr, driver.stats(), statsJson);
+        }
+        if (allocStats) {
+            out.flush();
+            printAllocProfile(std::cerr, allocJson);
+        }
+        if (ruleProfile) {
+            out.flush();
+            printRuleProfile(std::cerr, ruleJson);
+        }
+        if (!tracePath.empty()) {
+            out.flush();
+            writeTrace(tracePath);
+        }
     } catch (std::exception &ex) {
         std::cerr << "Ошибка: " << ex.what() << std::endl;
         return 1;
     }
-    return 0;
+    return status;
 }